@@ -0,0 +1,306 @@
+/*
+Microbenchmarks for the parts of the pipeline that don't involve CPLEX: NETGEN itself (at the Driver's grid of sizes and at much larger ones), the index lists it chooses nodes from, the random number generator, reading .min and binary instance files, and printout().  Results are written as JSON so that runs on different commits can be compared.  As with the Driver, NETGEN is linked into this program (compile it with MCNFLI_LIB defined).
+
+We expect two arguments: the name of the JSON output file, and a scratch directory for the instance files written and read by the file benchmarks (removed afterwards).  Two more are optional: the number of times each benchmark is repeated (default 3), and the largest node count to generate (default 131072).  Before the random number benchmarks, the bulk fill methods are checked against the sequence from random(), and the program stops if they disagree.  Each benchmark reports the fastest and median of its repeats, along with the number of items it handles (arcs, list entries, or random numbers), so throughput can be compared across sizes.
+*/
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <algorithm>
+#include <thread>
+#include "Netgen.h"
+#include "NetgenIndex.h"
+#include "NetgenRandom.h"
+#include "MinFile.h"
+#include "BinFile.h"
+#include "Timer.h"
+using namespace std;
+
+// NETGEN parameters, as in the Driver
+const int MINCOST = 1;
+const int MAXCOST = 100;
+const int SUPPLY = 10000;
+const int HICOST = 100;
+const int CAPACITATED = 100;
+const int MINCAP = 100;
+const int MAXCAP = 500;
+
+// One benchmark's results
+struct Measurement
+{
+	string name;
+	string params; // JSON members describing the case
+	long long items; // number of things handled per repeat
+	vector<double> seconds; // time of each repeat
+};
+
+// Prototypes
+static Netgen* make_netgen(long, int, int, int);
+static void write_json(ofstream&, const vector<Measurement>&, int);
+static bool check_random();
+
+int main(int argc, char* argv[])
+{
+	if (argc < 3 || argc > 5)
+	{
+		cout << "Expecting the following 2 (4) arguments: [output file] [scratch directory] ([repeats] [max nodes])\n";
+		return -1;
+	}
+	string output_name = argv[1];
+	string scratch = argv[2];
+	int repeats = 3;
+	if (argc >= 4)
+		repeats = stoi(argv[3]);
+	long max_nodes = 131072;
+	if (argc >= 5)
+		max_nodes = stol(argv[4]);
+	if (repeats < 1)
+	{
+		cout << "Number of repeats must be positive\n";
+		return -1;
+	}
+	timing_enabled = true; // for splitting printout() into generating and writing
+
+	vector<Measurement> results;
+	auto seconds_since = [](chrono::steady_clock::time_point start) { return chrono::duration<double>(chrono::steady_clock::now() - start).count(); };
+
+	// NETGEN at the Driver's sizes, with both parent types, and then at larger sizes
+	vector<pair<int, int>> sizes; // (m, multi)
+	for (int m : { 256, 512, 1024 })
+		for (int multi : { 4, 8, 12 })
+			sizes.push_back(make_pair(m, multi));
+	for (int m : { 16384, 131072 })
+		if (m <= max_nodes)
+			sizes.push_back(make_pair(m, 8));
+	for (pair<int, int> size : sizes)
+	{
+		for (int type : { 1, 0 })
+		{
+			Measurement meas;
+			meas.name = "netgen";
+			meas.params = "\"nodes\": " + to_string(size.first) + ", \"multi\": " + to_string(size.second) + ", \"parent\": " + to_string(type);
+			for (int r = 0; r < repeats; r++)
+			{
+				Netgen * gen = make_netgen(12345 + r, size.first, size.second, type);
+				Instance inst;
+				chrono::steady_clock::time_point start = chrono::steady_clock::now();
+				int rc = gen->generate(inst);
+				meas.seconds.push_back(seconds_since(start));
+				delete gen;
+				if (rc != 0)
+				{
+					Netgen::error_message(rc);
+					return -1;
+				}
+				meas.items = inst.DENSITY;
+			}
+			results.push_back(meas);
+		}
+	}
+
+	// Index lists: choose every entry in random order, or remove every entry by value in random order
+	for (int n : { 1000, 10000, 100000, 1000000 })
+	{
+		Measurement choose, remove;
+		choose.name = "index_choose";
+		remove.name = "index_remove";
+		choose.params = remove.params = "\"size\": " + to_string(n);
+		choose.items = remove.items = n;
+		for (int r = 0; r < repeats; r++)
+		{
+			NetgenRandom rando(4242 + r);
+			vector<long> positions(n);
+			for (int i = 0; i < n; i++)
+				positions[i] = rando.random(1, n - i);
+			NetgenIndex * index = new NetgenIndex(1, n);
+			chrono::steady_clock::time_point start = chrono::steady_clock::now();
+			for (int i = 0; i < n; i++)
+				index->choose_index(positions[i]);
+			choose.seconds.push_back(seconds_since(start));
+			delete index;
+
+			vector<int> values(n);
+			for (int i = 0; i < n; i++)
+				values[i] = i + 1;
+			for (int i = n - 1; i > 0; i--)
+				swap(values[i], values[rando.random(0, i)]);
+			index = new NetgenIndex(1, n);
+			start = chrono::steady_clock::now();
+			for (int i = 0; i < n; i++)
+				index->remove_index(values[i]);
+			remove.seconds.push_back(seconds_since(start));
+			delete index;
+		}
+		results.push_back(choose);
+		results.push_back(remove);
+	}
+
+	// Random numbers, one at a time and in bulk, after making sure that the bulk methods leave the generator where they should
+	if (check_random() == false)
+	{
+		cout << "Bulk random number check failed\n";
+		return -1;
+	}
+	{
+		const long n = 10000000;
+		Measurement single, bulk, streams;
+		single.name = "random";
+		bulk.name = "random_fill";
+		streams.name = "random_fill_streams";
+		single.params = bulk.params = streams.params = "\"range\": 99999999";
+		single.items = bulk.items = streams.items = n;
+		vector<long> values(n);
+		long long check = 0; // keeps the single draws from being optimized away
+		for (int r = 0; r < repeats; r++)
+		{
+			NetgenRandom rando(777 + r);
+			chrono::steady_clock::time_point start = chrono::steady_clock::now();
+			for (long i = 0; i < n; i++)
+				check += rando.random(1, 99999999);
+			single.seconds.push_back(seconds_since(start));
+
+			start = chrono::steady_clock::now();
+			rando.fill(1, 99999999, values.data(), n);
+			bulk.seconds.push_back(seconds_since(start));
+
+			start = chrono::steady_clock::now();
+			rando.fill_streams(1, 99999999, values.data(), n);
+			streams.seconds.push_back(seconds_since(start));
+			check += values[n - 1];
+		}
+		if (check == 0)
+			cout << '\n';
+		results.push_back(single);
+		results.push_back(bulk);
+		results.push_back(streams);
+	}
+
+	// Writing and reading instance files
+	for (pair<int, int> size : { make_pair(1024, 12), make_pair(16384, 8), make_pair(131072, 8) })
+	{
+		if (size.first > max_nodes)
+			continue;
+		string params = "\"nodes\": " + to_string(size.first) + ", \"multi\": " + to_string(size.second) + ", \"parent\": 1";
+		string min_name = scratch + "/bench_" + to_string(size.first) + ".min";
+		string bin_name = scratch + "/bench_" + to_string(size.first) + ".bin";
+		Measurement print, read_text, read_binary;
+		print.name = "printout_write";
+		read_text.name = "read_min";
+		read_binary.name = "read_bin";
+		print.params = read_text.params = read_binary.params = params;
+		for (int r = 0; r < repeats; r++)
+		{
+			// printout() generates and then writes, so only the writing phase is counted
+			Netgen * gen = make_netgen(54321, size.first, size.second, 1);
+			PhaseTimes & times = thread_phase_times();
+			times.clear();
+			int rc = gen->printout(min_name);
+			delete gen;
+			if (rc != 0)
+			{
+				cout << "Failed to write " << min_name << '\n';
+				return -1;
+			}
+			print.seconds.push_back(times.seconds[PHASE_WRITE]);
+
+			Instance inst;
+			chrono::steady_clock::time_point start = chrono::steady_clock::now();
+			rc = read_min(min_name, inst);
+			read_text.seconds.push_back(seconds_since(start));
+			if (rc != 0 || write_bin(bin_name, inst) != 0)
+			{
+				cout << "Failed to read " << min_name << " or write " << bin_name << '\n';
+				return -1;
+			}
+			print.items = read_text.items = read_binary.items = inst.DENSITY;
+
+			start = chrono::steady_clock::now();
+			rc = read_bin(bin_name, inst);
+			read_binary.seconds.push_back(seconds_since(start));
+			if (rc != 0)
+			{
+				cout << "Failed to read " << bin_name << '\n';
+				return -1;
+			}
+		}
+		remove(min_name.c_str());
+		remove(bin_name.c_str());
+		results.push_back(print);
+		results.push_back(read_text);
+		results.push_back(read_binary);
+	}
+
+	ofstream outfile;
+	outfile.open(output_name);
+	if (outfile.is_open() == false)
+	{
+		cout << "Output file " << output_name << " failed to open.\n";
+		return -1;
+	}
+	write_json(outfile, results, repeats);
+	outfile.close();
+	return 0;
+}
+
+// Sets up NETGEN the way the Driver does for a given seed, node count, arcs per node, and parent type (with the middle fraction of interdependencies).
+static Netgen* make_netgen(long seed, int NODES, int multi, int PARENT)
+{
+	int SOURCES = ceil(0.2 * NODES);
+	int SINKS = ceil(0.2 * NODES);
+	int DENSITY = multi * NODES;
+	int TOTSUPPLY = SUPPLY * ceil(NODES / 256);
+	int INTER = (PARENT == 0 ? ceil(0.05 * SINKS) : ceil(0.02 * DENSITY));
+	return new Netgen(seed, NODES, SOURCES, SINKS, DENSITY, MINCOST, MAXCOST, TOTSUPPLY, 0, 0, HICOST, CAPACITATED, MINCAP, MAXCAP, PARENT, INTER);
+}
+
+// Checks that fill() gives the same values as random(), that fill_streams() hands out the values of exactly the same stretch of the sequence (scaled as it scales them, in its own order), and that both leave the generator where that many calls to random() would.  The counts include ones that aren't a multiple of the lane count.
+static bool check_random()
+{
+	const long a = 1, b = 99999999;
+	for (size_t count : { 5, 16, 1003 })
+	{
+		NetgenRandom serial(31337), bulk(31337), streams(31337);
+		vector<long> values(count), stream_values(count), expected(count);
+		bulk.fill(a, b, values.data(), count);
+		streams.fill_streams(a, b, stream_values.data(), count);
+		for (size_t i = 0; i < count; i++)
+		{
+			if (values[i] != serial.random(a, b))
+				return false;
+			expected[i] = a + (long)(((unsigned long long)(serial.get_seed() - 1) * (b - a + 1)) >> 31);
+		}
+		sort(expected.begin(), expected.end());
+		sort(stream_values.begin(), stream_values.end());
+		if (stream_values != expected)
+			return false;
+		long next = serial.random(a, b);
+		if (bulk.random(a, b) != next || streams.random(a, b) != next)
+			return false;
+	}
+	return true;
+}
+
+// Writes every measurement with its fastest and median time, and the fastest time per item in nanoseconds.
+static void write_json(ofstream & outfile, const vector<Measurement> & results, int repeats)
+{
+	outfile.precision(9);
+	outfile << "{\n  \"repeats\": " << repeats << ",\n  \"hardware_threads\": " << thread::hardware_concurrency() << ",\n  \"benchmarks\": [\n";
+	for (size_t k = 0; k < results.size(); k++)
+	{
+		const Measurement & meas = results[k];
+		vector<double> sorted(meas.seconds);
+		sort(sorted.begin(), sorted.end());
+		double best = sorted.front();
+		double median = sorted[sorted.size() / 2];
+		outfile << "    { \"name\": \"" << meas.name << "\", " << meas.params << ", \"items\": " << meas.items;
+		outfile << ", \"min_seconds\": " << best << ", \"median_seconds\": " << median;
+		outfile << ", \"ns_per_item\": " << (meas.items > 0 ? best * 1e9 / meas.items : 0) << " }";
+		outfile << (k + 1 < results.size() ? ",\n" : "\n");
+	}
+	outfile << "  ]\n}\n";
+}
@@ -0,0 +1,158 @@
+/*
+Reads and writes the binary instance format described in BinFile.h.  Reading maps the file and copies each column straight into the instance's vectors, so load time is bounded by memory bandwidth rather than by number conversion.
+*/
+
+#include <fstream>
+#include <cstring>
+#include <climits>
+#include "MappedFile.h"
+#include "MinFile.h"
+#include "BinFile.h"
+#include "Timer.h"
+using namespace std;
+
+// Appends a column to the file, narrowing each entry to 32 bits.  Returns false if an entry doesn't fit.
+template <class T>
+static bool write_column(ofstream & outfile, const vector<T> & column, size_t count)
+{
+	const size_t chunk = 1 << 16; // entries per write
+	vector<int32_t> buffer;
+	buffer.reserve(chunk);
+	for (size_t i = 0; i < count; i += chunk)
+	{
+		buffer.clear();
+		for (size_t j = i; j < count && j < i + chunk; j++)
+		{
+			long long value = (long long)column[j];
+			if (value < INT32_MIN || value > INT32_MAX)
+				return false;
+			buffer.push_back((int32_t)value);
+		}
+		outfile.write((const char*)buffer.data(), buffer.size() * sizeof(int32_t));
+	}
+	return outfile.good();
+}
+
+// Copies a column out of the mapped file, widening each entry to the instance's type.  Advances the pointer past the column.
+template <class T>
+static void read_column(const char *& p, vector<T> & column, size_t count)
+{
+	column.resize(count);
+	if (sizeof(T) == sizeof(int32_t))
+		memcpy(column.data(), p, count * sizeof(int32_t));
+	else
+	{
+		const char* source = p;
+		for (size_t i = 0; i < count; i++)
+		{
+			int32_t value;
+			memcpy(&value, source + i * sizeof(int32_t), sizeof(int32_t)); // the mapping is aligned, but don't rely on it
+			column[i] = (T)value;
+		}
+	}
+	p += count * sizeof(int32_t);
+}
+
+// Writes the instance to a binary file.  Returns 0 if successful.
+int write_bin(string file_name, const Instance & inst)
+{
+	PhaseTimer timer(PHASE_WRITE);
+	ofstream outfile;
+	outfile.open(file_name, ios::binary);
+	if (outfile.is_open() == false)
+		return -1;
+
+	BinHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, BIN_MAGIC, sizeof(header.magic));
+	header.version = BIN_VERSION;
+	header.header_size = sizeof(BinHeader);
+	header.NODES = inst.NODES;
+	header.DENSITY = inst.DENSITY;
+	header.INTER = inst.INTER;
+	header.SOURCES = inst.SOURCES;
+	header.SINKS = inst.SINKS;
+	header.PARENT = inst.PARENT;
+	header.endian_check = 0x01020304;
+	outfile.write((const char*)&header, sizeof(header));
+
+	bool ok = outfile.good();
+	ok = ok && write_column(outfile, inst.b, inst.NODES);
+	ok = ok && write_column(outfile, inst.tail, inst.DENSITY);
+	ok = ok && write_column(outfile, inst.head, inst.DENSITY);
+	ok = ok && write_column(outfile, inst.u, inst.DENSITY);
+	ok = ok && write_column(outfile, inst.c, inst.DENSITY);
+	ok = ok && write_column(outfile, inst.parent, inst.INTER);
+	ok = ok && write_column(outfile, inst.child, inst.INTER);
+	outfile.close();
+	if (ok == false)
+		return -1;
+	return 0;
+}
+
+// Reads specified binary file.  Returns 0 if successful.
+int read_bin(string file_name, Instance & inst)
+{
+	PhaseTimer timer(PHASE_PARSE);
+	MappedFile file;
+	if (file.open(file_name) != 0)
+		return -1;
+
+	// Check that the header is one we understand and that the columns are all there
+	BinHeader header;
+	if (file.size() < sizeof(header))
+		return -1;
+	memcpy(&header, file.begin(), sizeof(header));
+	if (memcmp(header.magic, BIN_MAGIC, sizeof(header.magic)) != 0 || header.version != BIN_VERSION || header.endian_check != 0x01020304)
+		return -1;
+	if (header.header_size < sizeof(header) || header.NODES < 0 || header.DENSITY < 0 || header.INTER < 0
+		|| header.NODES > INT_MAX || header.DENSITY > INT_MAX || header.INTER > INT_MAX)
+		return -1;
+	size_t entries = (size_t)header.NODES + 4 * (size_t)header.DENSITY + 2 * (size_t)header.INTER;
+	if (file.size() != header.header_size + entries * sizeof(int32_t))
+		return -1;
+
+	inst.NODES = (long)header.NODES;
+	inst.DENSITY = (long)header.DENSITY;
+	inst.INTER = (long)header.INTER;
+	inst.SOURCES = (long)header.SOURCES;
+	inst.SINKS = (long)header.SINKS;
+	inst.PARENT = header.PARENT;
+	const char* p = file.begin() + header.header_size;
+	read_column(p, inst.b, inst.NODES);
+	read_column(p, inst.tail, inst.DENSITY);
+	read_column(p, inst.head, inst.DENSITY);
+	read_column(p, inst.u, inst.DENSITY);
+	read_column(p, inst.c, inst.DENSITY);
+	read_column(p, inst.parent, inst.INTER);
+	read_column(p, inst.child, inst.INTER);
+
+	// IDs are used directly as array indices by the solvers, so make sure they're in range
+	for (long i = 0; i < inst.DENSITY; i++)
+		if (inst.tail[i] >= (unsigned long)inst.NODES || inst.head[i] >= inst.NODES || inst.head[i] < -1)
+			return -1;
+	for (long i = 0; i < inst.INTER; i++)
+		if (inst.parent[i] >= (unsigned long)inst.DENSITY || inst.child[i] >= (unsigned long)inst.DENSITY)
+			return -1;
+	return 0;
+}
+
+// Checks whether a file is in the binary format.
+bool is_bin(string file_name)
+{
+	ifstream infile;
+	infile.open(file_name, ios::binary);
+	char magic[8];
+	if (infile.read(magic, sizeof(magic)))
+		return memcmp(magic, BIN_MAGIC, sizeof(magic)) == 0;
+	return false;
+}
+
+// Reads an instance in whichever format the file is in.  Returns 0 if successful.
+int read_instance(string file_name, Instance & inst)
+{
+	if (is_bin(file_name))
+		return read_bin(file_name, inst);
+	else
+		return read_min(file_name, inst);
+}
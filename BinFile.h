@@ -0,0 +1,30 @@
+#pragma once
+#include <string>
+#include <cstdint>
+#include "Instance.h"
+using namespace std;
+
+/*
+Binary instance format, an alternative to the .min text format that can be loaded without any parsing.  The file is a fixed header followed by one column per array, in the order b, tail, head, u, c, parent, child.  Every column entry is a little-endian 32-bit integer, using the same zero-indexed IDs as Instance (auxiliary arcs have a head of -1).
+*/
+#define BIN_MAGIC "MCNFLIbn" // first 8 bytes of every binary instance file
+#define BIN_VERSION 1
+
+struct BinHeader
+{
+	char magic[8]; // BIN_MAGIC
+	uint32_t version; // BIN_VERSION
+	uint32_t header_size; // bytes before the first column, so that later versions can extend the header
+	int64_t NODES;
+	int64_t DENSITY;
+	int64_t INTER;
+	int64_t SOURCES;
+	int64_t SINKS;
+	int32_t PARENT; // 0 if parents are sink nodes, 1 if parents are arcs
+	uint32_t endian_check; // 0x01020304 as written by the machine that made the file
+};
+
+int write_bin(string, const Instance&); // write instance to specified binary file; output 0 if it worked, or -1 if not
+int read_bin(string, Instance&); // read specified binary file into an instance; output 0 if it worked, or -1 if not
+bool is_bin(string); // whether the specified file starts with the binary magic bytes
+int read_instance(string, Instance&); // read either a binary or a .min file, depending on its contents
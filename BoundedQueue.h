@@ -0,0 +1,60 @@
+#pragma once
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+using namespace std;
+
+/*
+A first-in first-out queue shared between threads, holding at most a fixed number of items.  Pushing blocks while the queue is full and popping blocks while it is empty, so a fast producer can only run a limited distance ahead of its consumers.  Closing the queue wakes everyone up: later pushes fail, and pops fail once the remaining items are used up.
+*/
+template <class T>
+class BoundedQueue
+{
+private:
+	deque<T> items;
+	size_t capacity;
+	bool closed;
+	mutex lock;
+	condition_variable not_empty;
+	condition_variable not_full;
+public:
+	BoundedQueue(size_t max_items)
+	{
+		capacity = (max_items > 0 ? max_items : 1);
+		closed = false;
+	}
+
+	// Adds an item to the back of the queue, waiting for room if necessary.  Returns false (without adding) if the queue was closed.
+	bool push(T item)
+	{
+		unique_lock<mutex> guard(lock);
+		not_full.wait(guard, [this] { return closed || items.size() < capacity; });
+		if (closed)
+			return false;
+		items.push_back(item);
+		not_empty.notify_one();
+		return true;
+	}
+
+	// Removes an item from the front of the queue, waiting for one if necessary.  Returns false if the queue is closed and empty.
+	bool pop(T & item)
+	{
+		unique_lock<mutex> guard(lock);
+		not_empty.wait(guard, [this] { return closed || items.empty() == false; });
+		if (items.empty())
+			return false;
+		item = items.front();
+		items.pop_front();
+		not_full.notify_one();
+		return true;
+	}
+
+	// Stops accepting new items and releases any waiting threads.
+	void close()
+	{
+		lock_guard<mutex> guard(lock);
+		closed = true;
+		not_empty.notify_all();
+		not_full.notify_all();
+	}
+};
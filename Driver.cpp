@@ -1,23 +1,68 @@
 /*
 The main driver for generating MCNFLI computational trials. We use the portable RNG included in NETGEN to generate the seeds for our random networks.
+
+NETGEN and the three solvers are linked into this program (compile them with MCNFLI_LIB defined), so each trial is generated, solved, and recorded in memory without launching other programs or passing temporary files between them.
+
+Trials run in parallel.  One thread generates instances ahead of time into a bounded queue, while a pool of worker threads solves them, each trial in its own workspace.  Trials are committed in seed order, so the results files are identical to those of a serial run with the same master seed.  The optional argument is the number of solver threads (default: one per core).  When there are fewer workers than cores, each trial also solves several RR attempts at once (see solve_rr_attempts() in RrSolver.h).  Next to each results file, a "_phases" file breaks down the time that each recorded trial spent in each phase (see Timer.h), from generation and parsing to model building and solving.
+
+Generated instances and their LP solutions are kept in an on-disk cache (see InstanceCache.h), keyed by the NETGEN arguments and seed, so a rerun of the sweep (after a crash, or with different RR rules) loads them instead of generating and solving them again.  Cached LP results keep the time of the original solve.
+
+After every committed trial, the sweep's position is saved to a checkpoint file: the cell in progress, the state of the main RNG at the start of the cell, the cell's results file and how far it has been written, and the number of seeds used and trials recorded.  The file is replaced atomically (written under a temporary name, then renamed), so it always describes a committed trial.  Running with "--resume" continues from the checkpoint: the cell's results files are cut back to the checkpointed length and appended to, and the cell picks up at its next seed, so the finished sweep is the same as an uninterrupted one.  The checkpoint is deleted once the sweep is done, and a new sweep won't start while one is left over.
+
+Instances that can't have a feasible MILP are screened out before the MILP is solved: first with a max-flow check of the base network, then with the LP relaxation, which is solved first (its results are needed for RR anyway).  An infeasible LP implies an infeasible MILP, so only instances that pass both checks reach the MILP solver.  Every rejected seed is written to a "_rejected" file next to the cell's results, with the stage that rejected it, and the rejection is kept in the cache so that a rerun skips the seed without generating or solving anything.  Only proven infeasibility counts as a rejection: when the LP or MILP solver stops without an answer (at a time or memory limit, or on a numerical problem), the seed is skipped and written to the "_rejected" file as an error, but not cached, so a rerun tries it again.  At the end, the Driver estimates the MILP time saved by the screen from the average time of the MILPs it did solve.
+
+The MILP uses the standard formulation unless "--compact" is given, which switches to the compact one (see MilpSolver.h).  Run "MilpSolver [input] [output] -check" on instances from the sweep grid to confirm that the two agree before switching.
+
+The stages run in the order LP, RR, MILP.  Every RR solution is feasible for the MILP, so they're handed to CPLEX as MIP starts, with the best RR objective as an upper cutoff.
 */
 
 #include <iostream>
+#include <sstream>
 #include <string>
 #include <fstream>
 #include <cstdlib>
 #include <ctime>
+#include <cmath>
+#include <climits>
+#include <map>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <filesystem>
 #include "NetgenRandom.h"
+#include "Netgen.h"
+#include "MilpSolver.h"
+#include "LpSolver.h"
+#include "SideSimplex.h"
+#include "RrSolver.h"
+#include "ModelBuilder.h"
+#include "MaxFlow.h"
+#include "Timer.h"
+#include "InstanceCache.h"
+#include "BoundedQueue.h"
 using namespace std;
 
 // Global values
-const string netgen_file_name = "temp_network.min";
 const int cutoff = 500; // cutoff for RR tries
-const string temp_file_name = "temp_results.txt";
-const string parent_flow_name = "temp_parent_flow.txt";
-const string child_flow_name = "temp_child_flow.txt";
-int netgen_restarts = 0; // number of times we had to restart NETGEN
-int infeasible_milps = 0; // number of infeasible MILPs generated
+int workers = 1; // number of trials solved at once
+int cplex_threads = 0; // CPLEX thread limit for each solve (0 lets CPLEX decide)
+int rr_engine = RR_NATIVE; // engine for the rounded networks (RR_NATIVE or RR_CPLEX)
+int lp_engine = LP_CPLEX; // engine for the LP relaxation (LP_CPLEX or LP_NATIVE)
+int rr_parallel = 1; // RR attempts solved at once within a trial
+int milp_formulation = MILP_STANDARD; // formulation of the interdependencies in the MILP (see MilpSolver.h), MILP_COMPACT with "--compact"
+InstanceCache * cache = nullptr; // cache of instances and LP solutions (null if it couldn't be opened)
+const string cache_directory = "instance_cache";
+const unsigned long long cache_limit = 8ULL << 30; // bytes of cached files to keep
+const string checkpoint_name = "checkpoint.txt";
+
+// reasons for rejecting an instance, in the order that they are checked
+#define REJECT_NETWORK 1 // base network has no feasible flow
+#define REJECT_LP 2 // LP relaxation infeasible
+#define REJECT_MILP 3 // MILP infeasible
+#define REJECT_ERROR 4 // a solver failed without proving anything (a time or memory limit, or a numerical problem), so the instance isn't cached as rejected
+const string reject_names[] = { "", "network", "lp", "milp", "error" };
 
 // Constant NETGEN parameters
 const int MINCOST = 1;
@@ -31,705 +76,550 @@ const int MINCAP = 100;
 const int MAXCAP = 500;
 const int repeats = 60;
 
-// Prototypes
-int call_netgen(long, int, int, double, int);
-int call_milp();
-int call_lp();
-int call_rr(long, int);
+// RR variants, in the order that they are run and recorded
+const int rr_count = 7;
+const string rr_names[] = { "RRC0", "RRC1", "RRC5", "RRP0", "RRP1", "RRP5", "RRF" };
+const vector<RrVariant> rr_variants = { { 1, 0 }, { 1, 0.01 }, { 1, 0.05 }, { 2, 0 }, { 2, 0.01 }, { 2, 0.05 }, { 3, 0 } }; // mode (1 for RRC, 2 for RRP, 3 for RRF) and bound
 
-int main()
+// Counts and times over the whole sweep
+struct SweepTotals
+{
+	int netgen_restarts = 0; // number of times we had to restart NETGEN
+	int infeasible_milps = 0; // number of infeasible MILPs generated
+	int network_rejects = 0; // instances rejected by the network check
+	int lp_rejects = 0; // instances rejected by the LP
+	int cached_rejects = 0; // seeds skipped because an earlier run rejected them
+	int solver_errors = 0; // instances skipped because the LP or MILP solver failed without an answer
+	long milp_solves = 0; // MILPs solved (feasible or not)
+	double milp_seconds = 0; // time spent building and solving those MILPs
+	double screen_seconds = 0; // time spent on the network checks and LPs of rejected instances
+} totals;
+
+// Position of the sweep, saved after every committed trial so that an interrupted sweep can be resumed
+struct Checkpoint
 {
-	// Output statistics
-	int rrc0_tries, rrc1_tries, rrc5_tries, rrp0_tries, rrp1_tries, rrp5_tries, rrf_tries;
-	double milp_cost, milp_time, lp_cost, lp_time, rrc0_cost, rrc1_cost, rrc5_cost, rrp0_cost, rrp1_cost, rrp5_cost, rrf_cost;
+	int cell = 0; // index of the cell in progress, in sweep order
+	long rng_state = 0; // seed of the main RNG at the start of the cell's sequence of seeds
+	string result_name; // results file of the cell, without the ".txt"
+	long committed = 0; // number of the cell's seeds used so far
+	int recorded = 0; // number of the cell's trials recorded so far
+	long long results_bytes = 0; // length of the results file after the last recorded trial
+	long long phases_bytes = 0; // length of the phase times file after the last recorded trial
+	long long rejected_bytes = 0; // length of the rejected seeds file after the last commit
+	SweepTotals totals;
+};
+
+// Output statistics for a single trial
+struct Trial
+{
+	long seed;
+	Result milp;
+	Result lp;
+	Result rr[rr_count];
+	PhaseTimes phases; // time spent in each phase of generating and solving the trial
+};
+
+// Everything belonging to one trial while it moves between threads, so that no two trials share any state
+struct Workspace
+{
+	long index; // position of the trial's seed in its cell's sequence of seeds
+	vector<long> netgen_args; // the NETGEN arguments for the trial, which identify it in the cache
+	int rc; // 0 if successful, the reason (REJECT_*) if the instance was rejected, or negative if NETGEN failed
+	bool cached_reject; // whether the rejection was loaded from the cache
+	Instance inst;
+	Trial trial;
+	ostringstream log; // progress messages, printed once the trial is committed
+	NetworkMatrix * matrix = nullptr; // the instance's incidence matrix, built the first time a CPLEX model needs it and shared by the trial's LP, RR and MILP models
+};
+
+// Prototypes
+vector<long> netgen_arguments(long, int, int, double, int);
+int call_netgen(const vector<long>&, Instance&);
+const NetworkMatrix& trial_matrix(Workspace&);
+int call_milp(const Instance&, Result&, const Result*, const NetworkMatrix&);
+int call_lp(const Instance&, Result&, Workspace&);
+int call_rr(const Instance&, const Result&, long, Result*, ostream&, Workspace&);
+int run_cell(NetgenRandom*, int, int, double, int, ofstream&, ofstream&, ofstream&, Checkpoint&);
+int generate_trial(Workspace&, int, int, double, int);
+int solve_trial(Workspace&);
+int screen_trial(Workspace&);
+void write_trial(ofstream&, const Trial&, int, int, double, int);
+void write_phases(ofstream&, const Trial&);
+void count_trial(const Workspace&);
+void report_screen(ostream&);
+int write_checkpoint(const Checkpoint&);
+int read_checkpoint(Checkpoint&);
+
+int main(int argc, char* argv[])
+{
+	timing_enabled = true; // for the phase breakdown files
+	// Split the cores between trials and CPLEX
+	int cores = thread::hardware_concurrency();
+	if (cores < 1)
+		cores = 1;
+	workers = cores;
+	bool resume = false;
+	for (int a = 1; a < argc; a++)
+	{
+		if (string(argv[a]) == "--resume")
+			resume = true;
+		else if (string(argv[a]) == "--compact")
+			milp_formulation = MILP_COMPACT;
+		else
+			workers = stoi(argv[a]);
+	}
+	if (workers < 1)
+	{
+		cout << "Expecting at most 3 arguments: ([number of worker threads]) (--resume) (--compact)\n";
+		return -1;
+	}
+	cplex_threads = cores / workers;
+	if (cplex_threads < 1)
+		cplex_threads = 1;
+	rr_parallel = cplex_threads; // a trial's cores go to its RR attempts, which give the same results however many run at once
+
+	cache = new InstanceCache(cache_directory, cache_limit);
+	if (cache->open() != 0)
+	{
+		cout << "Cache directory " << cache_directory << " failed to open.  Running without a cache.\n";
+		delete cache;
+		cache = nullptr;
+	}
+
+	// Pick up an interrupted sweep, or make sure that we aren't about to overwrite one
+	Checkpoint state;
+	if (resume)
+	{
+		if (read_checkpoint(state) != 0)
+		{
+			cout << "Checkpoint file " << checkpoint_name << " is missing or unreadable.  Nothing to resume.\n";
+			return -1;
+		}
+		totals = state.totals;
+		cout << "Resuming cell " << state.cell + 1 << " (" << state.result_name << ") after " << state.recorded << " recorded trials.\n";
+	}
+	else if (filesystem::exists(checkpoint_name))
+	{
+		cout << "Checkpoint file " << checkpoint_name << " is left over from an unfinished sweep.  Run with --resume to continue it, or delete it to start over.\n";
+		return -1;
+	}
 
 	NetgenRandom * rand_main = new NetgenRandom(time(NULL)); // random number to use as the NETGEN seed
 
+	const int type_set[] = { 1, 0 }; // 0 for node parents, 1 for arc parents
 	const int node_set[] = { 256, 512, 1024 }; // m
 	const int multi_set[] = { 4, 8, 12 }; // multi
 	const double node_frac_set[] = { 0.02, 0.05, 0.1, 0.15 }; // fractions of interdependencies for parent nodes
 	const double arc_frac_set[] = { 0.01, 0.02, 0.05, 0.1 }; // fractions of interdependencies for parent arcs
-	int type = 1; // 0 for node parents, 1 for arc parents
 
-	// Arc parent trials
-	for (int m : node_set) // { 256, 512, 1024 }
+	// Arc parent trials, followed by node parent trials
+	int cell = 0;
+	for (int type : type_set)
 	{
-		for (int multi : multi_set) // {4, 8, 12 }
+		const double * frac_set = (type == 1 ? arc_frac_set : node_frac_set);
+		for (int m : node_set) // { 256, 512, 1024 }
 		{
-			for (double fraction : arc_frac_set) // { 0.01, 0.02, 0.05, 0.1 }
+			for (int multi : multi_set) // {4, 8, 12 }
 			{
-				string result_file_name = "results" + to_string(rand_main->random(10000000, 99999999)) + ".txt";
-				ofstream outfile;
-				outfile.open(result_file_name);
-				outfile << fixed;
-
-				if (outfile.is_open())
+				for (int f = 0; f < 4; f++, cell++)
 				{
-					for (int i = 0; i < repeats; i++) // 60
+					double fraction = frac_set[f];
+					if (resume && cell < state.cell)
+						continue; // finished before the interruption
+
+					ofstream outfile, phasefile, rejectfile;
+					string result_name;
+					if (resume && cell == state.cell)
 					{
-						long seed = rand_main->random(1, 99999999); // choose RNG seed for this instance
-						cout << "\n\n\n============================================================\n";
-						cout << "m = " << m << ", multi = " << multi << ", fraction = " << fraction << ", arc parents\n";
-						cout << "Iteration " << i + 1 << '/' << repeats << ", seed = " << seed << '\n';
-						cout << "============================================================\n";
-						cout << "\nCalling NETGEN... ";
-						if (call_netgen(seed, m, multi, fraction, type) == 0) // call NETGEN, and move on only if it worked
+						// Drop anything written after the last checkpointed trial, and carry on from there
+						result_name = state.result_name;
+						rand_main->set_random(state.rng_state);
+						error_code results_ec, phases_ec, rejected_ec;
+						filesystem::resize_file(result_name + ".txt", state.results_bytes, results_ec);
+						filesystem::resize_file(result_name + "_phases.txt", state.phases_bytes, phases_ec);
+						filesystem::resize_file(result_name + "_rejected.txt", state.rejected_bytes, rejected_ec);
+						if (!results_ec && !phases_ec && !rejected_ec)
 						{
-							cout << "Succsessful!\n\nSolving MILP... ";
-							if (call_milp() == 0) // call MILP solver, and move on only if it worked
-							{
-								// Read in MILP results
-								ifstream milpin;
-								milpin.open(temp_file_name);
-								if (milpin.is_open())
-								{
-									string line;
-									getline(milpin, line);
-									milp_cost = stod(line);
-									getline(milpin, line);
-									milp_time = stod(line);
-									milpin.close();
-
-									cout << "Successful!\n\nSolving LP... ";
-									call_lp(); // call LP solver
-
-									// Read in LP results
-									ifstream lpin;
-									lpin.open(temp_file_name);
-									if (lpin.is_open())
-									{
-										string line;
-										getline(lpin, line);
-										lp_cost = stod(line);
-										getline(lpin, line);
-										lp_time = stod(line);
-										lpin.close();
-
-										cout << "Successful!\n\nSolving RRC0... ";
-
-										int latest_tries; // number of tries reported by the RR methods
-										
-										// RRC Trials
-
-										// RRC0
-										latest_tries = call_rr(seed, 1, 0);
-										if (latest_tries > 0)
-										{
-											// Read in RRC0 results
-											ifstream rrin;
-											rrin.open(temp_file_name);
-											if (rrin.is_open())
-											{
-												string line;
-												getline(rrin, line);
-												rrc0_cost = stod(line);
-												getline(rrin, line);
-												rrc0_time = stod(line);
-												rrin.close();
-
-												rrc0_tries = latest_tries;
-
-												cout << "Successful!\n\nSolving RRC1... ";
-											}
-											else
-											{
-												cout << "Output file failed to open.  Quitting.\n\a";
-												return -1;
-											}
-										}
-										else
-										{
-											// RRC0 failed
-											rrc0_cost = rrc0_tries = -999;
-											cout << "Timed out.\n\nSolving RRC1... ";
-										}
-
-										// RRC1
-										latest_tries = call_rr(seed, 1, 0.01);
-										if (latest_tries > 0)
-										{
-											// Read in RRC1 results
-											ifstream rrin;
-											rrin.open(temp_file_name);
-											if (rrin.is_open())
-											{
-												string line;
-												getline(rrin, line);
-												rrc1_cost = stod(line);
-												getline(rrin, line);
-												rrc1_time = stod(line);
-												rrin.close();
-
-												rrc1_tries = latest_tries;
-
-												cout << "Successful!\n\nSolving RRC5... ";
-											}
-											else
-											{
-												cout << "Output file failed to open.  Quitting.\n\a";
-												return -1;
-											}
-										}
-										else
-										{
-											// RRC1 failed
-											rrc1_cost = rrc1_tries = -999;
-											cout << "Timed out.\n\nSolving RRC5... ";
-										}
-
-										// RRC5
-										latest_tries = call_rr(seed, 1, 0.05);
-										if (latest_tries > 0)
-										{
-											// Read in RRC5 results
-											ifstream rrin;
-											rrin.open(temp_file_name);
-											if (rrin.is_open())
-											{
-												string line;
-												getline(rrin, line);
-												rrc5_cost = stod(line);
-												getline(rrin, line);
-												rrc5_time = stod(line);
-												rrin.close();
-
-												rrc5_tries = latest_tries;
-
-												cout << "Successful!\n\nSolving RRP0... ";
-											}
-											else
-											{
-												cout << "Output file failed to open.  Quitting.\n\a";
-												return -1;
-											}
-										}
-										else
-										{
-											// RRC5 failed
-											rrc5_cost = rrc5_tries = -999;
-											cout << "Timed out.\n\nSolving RRP0... ";
-										}
-
-										// RRP0
-										latest_tries = call_rr(seed, 2, 0);
-										if (latest_tries > 0)
-										{
-											// Read in RRP0 results
-											ifstream rrin;
-											rrin.open(temp_file_name);
-											if (rrin.is_open())
-											{
-												string line;
-												getline(rrin, line);
-												rrp0_cost = stod(line);
-												getline(rrin, line);
-												rrp0_time = stod(line);
-												rrin.close();
-
-												rrp0_tries = latest_tries;
-
-												cout << "Successful!\n\nSolving RRP1... ";
-											}
-											else
-											{
-												cout << "Output file failed to open.  Quitting.\n\a";
-												return -1;
-											}
-										}
-										else
-										{
-											// RRP0 failed
-											rrp0_cost = rrp0_tries = -999;
-											cout << "Timed out.\n\nSolving RRP1... ";
-										}
-
-										// RRP1
-										latest_tries = call_rr(seed, 2, 0.01);
-										if (latest_tries > 0)
-										{
-											// Read in RRP1 results
-											ifstream rrin;
-											rrin.open(temp_file_name);
-											if (rrin.is_open())
-											{
-												string line;
-												getline(rrin, line);
-												rrp1_cost = stod(line);
-												getline(rrin, line);
-												rrp1_time = stod(line);
-												rrin.close();
-
-												rrp1_tries = latest_tries;
-
-												cout << "Successful!\n\nSolving RRP5... ";
-											}
-											else
-											{
-												cout << "Output file failed to open.  Quitting.\n\a";
-												return -1;
-											}
-										}
-										else
-										{
-											// RRP1 failed
-											rrp1_cost = rrp1_tries = -999;
-											cout << "Timed out.\n\nSolving RRP5... ";
-										}
-
-										// RRP5
-										latest_tries = call_rr(seed, 2, 0.05);
-										if (latest_tries > 0)
-										{
-											// Read in RRP5 results
-											ifstream rrin;
-											rrin.open(temp_file_name);
-											if (rrin.is_open())
-											{
-												string line;
-												getline(rrin, line);
-												rrp5_cost = stod(line);
-												getline(rrin, line);
-												rrp5_time = stod(line);
-												rrin.close();
-
-												rrp5_tries = latest_tries;
-
-												cout << "Successful!\n\nSolving RRF... ";
-											}
-											else
-											{
-												cout << "Output file failed to open.  Quitting.\n\a";
-												return -1;
-											}
-										}
-										else
-										{
-											// RRP5 failed
-											rrp5_cost = rrp5_tries = -999;
-											cout << "Timed out.\n\nSolving RRF... ";
-										}
-
-										// RRF
-										latest_tries = call_rr(seed, 3, 0);
-										if (latest_tries > 0)
-										{
-											// Read in RRF results
-											ifstream rrin;
-											rrin.open(temp_file_name);
-											if (rrin.is_open())
-											{
-												string line;
-												getline(rrin, line);
-												rrf_cost = stod(line);
-												getline(rrin, line);
-												rrf_time = stod(line);
-												rrin.close();
-
-												rrf_tries = latest_tries;
-
-												cout << "Successful!\n";
-											}
-											else
-											{
-												cout << "Output file failed to open.  Quitting.\n\a";
-												return -1;
-											}
-										}
-										else
-										{
-											// RRF failed
-											rrf_cost = rrf_tries = -999;
-											cout << "Timed out.\n";
-										}
-									}
-									else
-									{
-										cout << "Output file failed to open.  Quitting.\n\a";
-										return -1;
-									}
-								}
-								else
-								{
-									cout << "Output file failed to open.  Quitting.\n\a";
-									return -1;
-								}
-							}
-							else
-							{
-								cout << "MILP infeasible.  Creating a different instance.\n";
-								infeasible_milps++;
-								i--;
-								continue;
-							}
-							// Write row of results to output file
-							outfile << seed << '\t' << m << '\t' << multi * m << '\t' << ceil(fraction * multi * m) << '\t' << type << '\t' << milp_cost << '\t' << milp_time << '\t' << lp_cost << '\t' << lp_time << '\t' << rrc_cost << '\t' << rrc_time << '\t' << rrc_tries << '\t' << rrp_cost << '\t' << rrp_time << '\t' << rrp_tries << '\t' << rrf_cost << '\t' << rrf_time << '\t' << rrf_tries << '\n';
+							outfile.open(result_name + ".txt", ios::app);
+							phasefile.open(result_name + "_phases.txt", ios::app);
+							rejectfile.open(result_name + "_rejected.txt", ios::app);
 						}
-						else
+					}
+					else
+					{
+						result_name = "results" + to_string(rand_main->random(10000000, 99999999));
+						outfile.open(result_name + ".txt");
+						phasefile.open(result_name + "_phases.txt");
+						rejectfile.open(result_name + "_rejected.txt");
+						state = Checkpoint();
+						state.cell = cell;
+						state.rng_state = rand_main->get_seed();
+						state.result_name = result_name;
+						state.totals = totals;
+					}
+					string result_file_name = result_name + ".txt";
+					outfile << fixed;
+					phasefile << fixed;
+
+					if (outfile.is_open() && phasefile.is_open() && rejectfile.is_open())
+					{
+						if (write_checkpoint(state) != 0)
 						{
-							cout << "NETGEN failed to create output file.  Quitting.\n\a";
+							cout << "Checkpoint file " << checkpoint_name << " failed to save.  Quitting.\n\a";
 							return -1;
 						}
+						if (run_cell(rand_main, m, multi, fraction, type, outfile, phasefile, rejectfile, state) != 0)
+						{
+							cout << "NETGEN failed to create instance.  Quitting.\n\a";
+							return -1;
+						}
+						outfile.close();
+						phasefile.close();
+						rejectfile.close();
+					}
+					else
+					{
+						cout << "Results file " << result_file_name << " failed to open.  Quitting.\n\a";
+						return -1;
 					}
-
-					outfile.close();
-				}
-				else
-				{
-					cout << "NETGEN failed to create output file.  Quitting.\n\a";
-					return -1;
 				}
 			}
 		}
 	}
 
-	// Node parent trials
-	type = 0;
-	for (int m : node_set) // { 256, 512, 1024 }
+	error_code ec;
+	filesystem::remove(checkpoint_name, ec); // nothing left to resume
+
+	cout << "\n\n\nAll tests run!\nNETGEN restarted " << totals.netgen_restarts << " times.\n";
+	cout << totals.infeasible_milps << " infeasible MILPs generated.\n";
+	report_screen(cout);
+	if (cache != nullptr)
+		cache->print_stats(cout);
+	cout << "\nPress[Enter] to close.\n\a";
+	cin.get();
+	delete rand_main;
+	delete cache;
+	return 0;
+}
+
+/*
+Runs all repeats of one (m, multi, fraction, type) cell and writes their rows to the results file.  Seeds are drawn speculatively by jumping ahead in the main RNG, and each finished trial is committed in seed order: a successful trial is recorded, while an infeasible MILP moves on to the next seed, just as in the serial loop.  Rejected seeds are written to the rejected seeds file as they are committed.  Every commit is saved to the checkpoint, and a resumed cell starts from the checkpoint's seed and trial counts.  Once enough trials have been recorded, the leftover speculative trials are thrown away and the main RNG is advanced past only the seeds that were committed.  Returns 0 if successful, or -1 if NETGEN failed or the checkpoint couldn't be saved.
+*/
+int run_cell(NetgenRandom * rand_main, int m, int multi, double fraction, int type, ofstream & outfile, ofstream & phasefile, ofstream & rejectfile, Checkpoint & state)
+{
+	const long lookahead = 4 * workers; // maximum number of uncommitted trials in flight
+	BoundedQueue<Workspace*> generated(2 * workers); // instances waiting to be solved
+	atomic<long> limit(LONG_MAX); // trials at or past this index are no longer needed
+	long committed = state.committed; // number of trials committed so far
+	map<long, Workspace*> finished; // solved trials waiting to be committed
+	mutex finished_lock;
+	condition_variable finished_change;
+
+	// Generation stage: create instances in seed order, staying a bounded distance ahead of the commits
+	thread generator([&]()
 	{
-		for (int multi : multi_set) // {4, 8, 12 }
+		for (long k = state.committed; k < limit; k++)
 		{
-			for (double fraction : node_frac_set) // { 0.02, 0.05, 0.1, 0.15 }
 			{
-				string result_file_name = "results" + to_string(rand_main->random(10000000, 99999999)) + ".txt";
-				ofstream outfile;
-				outfile.open(result_file_name);
-				outfile << fixed;
-
-				if (outfile.is_open())
-				{
-					for (int i = 0; i < repeats; i++) // 60
-					{
-						long seed = rand_main->random(1, 99999999); // choose RNG seed for this instance
-						cout << "\n\n\n============================================================\n";
-						cout << "m = " << m << ", multi = " << multi << ", fraction = " << fraction << ", node parents\n";
-						cout << "Iteration " << i + 1 << '/' << repeats << ", seed = " << seed << '\n';
-						cout << "============================================================\n";
-						cout << "\nCalling NETGEN... ";
-						if (call_netgen(seed, m, multi, fraction, type) == 0) // call NETGEN, and move on only if it worked
-						{
-							cout << "Succsessful!\n\nSolving MILP... ";
-							if (call_milp() == 0) // call MILP solver, and move on only if it worked
-							{
-								// Read in MILP results
-								ifstream milpin;
-								milpin.open(temp_file_name);
-								if (milpin.is_open())
-								{
-									string line;
-									getline(milpin, line);
-									milp_cost = stod(line);
-									getline(milpin, line);
-									milp_time = stod(line);
-									milpin.close();
-
-									cout << "Successful!\n\nSolving LP... ";
-									call_lp(); // call LP solver
-
-									// Read in LP results
-									ifstream lpin;
-									lpin.open(temp_file_name);
-									if (lpin.is_open())
-									{
-										string line;
-										getline(lpin, line);
-										lp_cost = stod(line);
-										getline(lpin, line);
-										lp_time = stod(line);
-										lpin.close();
-
-										cout << "Successful!\n\nSolving RRC0... ";
-
-										int latest_tries; // number of tries reported by the RR methods
-
-										// RRC Trials
-
-										// RRC0
-										latest_tries = call_rr(seed, 1, 0);
-										if (latest_tries > 0)
-										{
-											// Read in RRC0 results
-											ifstream rrin;
-											rrin.open(temp_file_name);
-											if (rrin.is_open())
-											{
-												string line;
-												getline(rrin, line);
-												rrc0_cost = stod(line);
-												getline(rrin, line);
-												rrc0_time = stod(line);
-												rrin.close();
-
-												rrc0_tries = latest_tries;
-
-												cout << "Successful!\n\nSolving RRC1... ";
-											}
-											else
-											{
-												cout << "Output file failed to open.  Quitting.\n\a";
-												return -1;
-											}
-										}
-										else
-										{
-											// RRC0 failed
-											rrc0_cost = rrc0_tries = -999;
-											cout << "Timed out.\n\nSolving RRC1... ";
-										}
-
-										// RRC1
-										latest_tries = call_rr(seed, 1, 0.01);
-										if (latest_tries > 0)
-										{
-											// Read in RRC1 results
-											ifstream rrin;
-											rrin.open(temp_file_name);
-											if (rrin.is_open())
-											{
-												string line;
-												getline(rrin, line);
-												rrc1_cost = stod(line);
-												getline(rrin, line);
-												rrc1_time = stod(line);
-												rrin.close();
-
-												rrc1_tries = latest_tries;
-
-												cout << "Successful!\n\nSolving RRC5... ";
-											}
-											else
-											{
-												cout << "Output file failed to open.  Quitting.\n\a";
-												return -1;
-											}
-										}
-										else
-										{
-											// RRC1 failed
-											rrc1_cost = rrc1_tries = -999;
-											cout << "Timed out.\n\nSolving RRC5... ";
-										}
-
-										// RRC5
-										latest_tries = call_rr(seed, 1, 0.05);
-										if (latest_tries > 0)
-										{
-											// Read in RRC5 results
-											ifstream rrin;
-											rrin.open(temp_file_name);
-											if (rrin.is_open())
-											{
-												string line;
-												getline(rrin, line);
-												rrc5_cost = stod(line);
-												getline(rrin, line);
-												rrc5_time = stod(line);
-												rrin.close();
-
-												rrc5_tries = latest_tries;
-
-												cout << "Successful!\n\nSolving RRP0... ";
-											}
-											else
-											{
-												cout << "Output file failed to open.  Quitting.\n\a";
-												return -1;
-											}
-										}
-										else
-										{
-											// RRC5 failed
-											rrc5_cost = rrc5_tries = -999;
-											cout << "Timed out.\n\nSolving RRP0... ";
-										}
-
-										// RRP0
-										latest_tries = call_rr(seed, 2, 0);
-										if (latest_tries > 0)
-										{
-											// Read in RRP0 results
-											ifstream rrin;
-											rrin.open(temp_file_name);
-											if (rrin.is_open())
-											{
-												string line;
-												getline(rrin, line);
-												rrp0_cost = stod(line);
-												getline(rrin, line);
-												rrp0_time = stod(line);
-												rrin.close();
-
-												rrp0_tries = latest_tries;
-
-												cout << "Successful!\n\nSolving RRP1... ";
-											}
-											else
-											{
-												cout << "Output file failed to open.  Quitting.\n\a";
-												return -1;
-											}
-										}
-										else
-										{
-											// RRP0 failed
-											rrp0_cost = rrp0_tries = -999;
-											cout << "Timed out.\n\nSolving RRP1... ";
-										}
-
-										// RRP1
-										latest_tries = call_rr(seed, 2, 0.01);
-										if (latest_tries > 0)
-										{
-											// Read in RRP1 results
-											ifstream rrin;
-											rrin.open(temp_file_name);
-											if (rrin.is_open())
-											{
-												string line;
-												getline(rrin, line);
-												rrp1_cost = stod(line);
-												getline(rrin, line);
-												rrp1_time = stod(line);
-												rrin.close();
-
-												rrp1_tries = latest_tries;
-
-												cout << "Successful!\n\nSolving RRP5... ";
-											}
-											else
-											{
-												cout << "Output file failed to open.  Quitting.\n\a";
-												return -1;
-											}
-										}
-										else
-										{
-											// RRP1 failed
-											rrp1_cost = rrp1_tries = -999;
-											cout << "Timed out.\n\nSolving RRP5... ";
-										}
-
-										// RRP5
-										latest_tries = call_rr(seed, 2, 0.05);
-										if (latest_tries > 0)
-										{
-											// Read in RRP5 results
-											ifstream rrin;
-											rrin.open(temp_file_name);
-											if (rrin.is_open())
-											{
-												string line;
-												getline(rrin, line);
-												rrp5_cost = stod(line);
-												getline(rrin, line);
-												rrp5_time = stod(line);
-												rrin.close();
-
-												rrp5_tries = latest_tries;
-
-												cout << "Successful!\n\nSolving RRF... ";
-											}
-											else
-											{
-												cout << "Output file failed to open.  Quitting.\n\a";
-												return -1;
-											}
-										}
-										else
-										{
-											// RRP5 failed
-											rrp5_cost = rrp5_tries = -999;
-											cout << "Timed out.\n\nSolving RRF... ";
-										}
-
-										// RRF
-										latest_tries = call_rr(seed, 3, 0);
-										if (latest_tries > 0)
-										{
-											// Read in RRF results
-											ifstream rrin;
-											rrin.open(temp_file_name);
-											if (rrin.is_open())
-											{
-												string line;
-												getline(rrin, line);
-												rrf_cost = stod(line);
-												getline(rrin, line);
-												rrf_time = stod(line);
-												rrin.close();
-
-												rrf_tries = latest_tries;
-
-												cout << "Successful!\n";
-											}
-											else
-											{
-												cout << "Output file failed to open.  Quitting.\n\a";
-												return -1;
-											}
-										}
-										else
-										{
-											// RRF failed
-											rrf_cost = rrf_tries = -999;
-											cout << "Timed out.\n";
-										}
-									}
-									else
-									{
-										cout << "Output file failed to open.  Quitting.\n\a";
-										return -1;
-									}
-								}
-								else
-								{
-									cout << "Output file failed to open.  Quitting.\n\a";
-									return -1;
-								}
-							}
-							else
-							{
-								cout << "MILP infeasible.  Creating a different instance.\n";
-								infeasible_milps++;
-								i--;
-								continue;
-							}
-							// Write row of results to output file
-							outfile << seed << '\t' << m << '\t' << multi * m << '\t' << ceil(fraction * ceil(0.2 * m)) << '\t' << type << '\t' << milp_cost << '\t' << milp_time << '\t' << lp_cost << '\t' << lp_time << '\t' << rrc_cost << '\t' << rrc_time << '\t' << rrc_tries << '\t' << rrp_cost << '\t' << rrp_time << '\t' << rrp_tries << '\t' << rrf_cost << '\t' << rrf_time << '\t' << rrf_tries << '\n';
-						}
-						else
-						{
-							cout << "NETGEN failed to create output file.  Quitting.\n\a";
-							return -1;
-						}
-					}
+				unique_lock<mutex> guard(finished_lock);
+				finished_change.wait(guard, [&] { return k < committed + lookahead || k >= limit; });
+			}
+			if (k >= limit)
+				break;
+			Workspace * ws = new Workspace();
+			ws->index = k;
+			ws->trial.seed = rand_main->substream(k, 1).random(1, 99999999); // choose RNG seed for this instance (the k'th draw from the main RNG)
+			thread_phase_times().clear();
+			ws->rc = generate_trial(*ws, m, multi, fraction, type);
+			ws->trial.phases = thread_phase_times();
+			if (generated.push(ws) == false)
+			{
+				delete ws;
+				break;
+			}
+		}
+		generated.close();
+	});
 
-					outfile.close();
-				}
-				else
+	// Solving stage: each worker takes the next generated instance and runs every solver on it
+	vector<thread> solvers;
+	for (int w = 0; w < workers; w++)
+	{
+		solvers.push_back(thread([&]()
+		{
+			Workspace * ws;
+			while (generated.pop(ws))
+			{
+				if (ws->index < limit && ws->rc == 0)
 				{
-					cout << "NETGEN failed to create output file.  Quitting.\n\a";
-					return -1;
+					thread_phase_times().clear();
+					ws->rc = solve_trial(*ws);
+					ws->trial.phases.add(thread_phase_times());
 				}
+				lock_guard<mutex> guard(finished_lock);
+				finished[ws->index] = ws;
+				finished_change.notify_all();
 			}
+		}));
+	}
+
+	// Commit the trials in seed order
+	int status = 0;
+	int i = state.recorded; // number of trials recorded
+	while (i < repeats)
+	{
+		Workspace * ws;
+		{
+			unique_lock<mutex> guard(finished_lock);
+			finished_change.wait(guard, [&] { return finished.count(committed) > 0; });
+			ws = finished[committed];
+			finished.erase(committed);
+			committed++;
+			finished_change.notify_all();
+		}
+
+		cout << "\n\n\n============================================================\n";
+		cout << "m = " << m << ", multi = " << multi << ", fraction = " << fraction << (type == 1 ? ", arc parents\n" : ", node parents\n");
+		cout << "Iteration " << i + 1 << '/' << repeats << ", seed = " << ws->trial.seed << '\n';
+		cout << "============================================================\n";
+		cout << ws->log.str();
+
+		int rc = ws->rc;
+		if (rc == 0)
+		{
+			// Write row of results to output file
+			write_trial(outfile, ws->trial, m, multi, fraction, type);
+			write_phases(phasefile, ws->trial);
+			i++;
+		}
+		else if (rc > 0)
+			rejectfile << ws->trial.seed << '\t' << reject_names[rc] << '\n';
+		count_trial(*ws);
+		delete ws;
+		if (rc < 0)
+		{
+			status = -1;
+			break;
+		}
+
+		// Save the position only once the trial's rows are safely in the files
+		outfile.flush();
+		phasefile.flush();
+		rejectfile.flush();
+		state.committed = committed;
+		state.recorded = i;
+		error_code ec;
+		state.results_bytes = filesystem::file_size(state.result_name + ".txt", ec);
+		state.phases_bytes = filesystem::file_size(state.result_name + "_phases.txt", ec);
+		state.rejected_bytes = filesystem::file_size(state.result_name + "_rejected.txt", ec);
+		state.totals = totals;
+		if (!outfile || !phasefile || !rejectfile || ec || write_checkpoint(state) != 0)
+		{
+			cout << "Results or checkpoint failed to save.  Quitting.\n\a";
+			status = -1;
+			break;
 		}
 	}
 
-	cout << "\n\n\nAll tests run!\nNETGEN restarted " << netgen_restarts << " times.\n";
-	cout << infeasible_milps << " infeasible MILPs generated.\n\nPress[Enter] to close.\n\a";
-	cin.get();
-	delete rand_main;
+	// Stop the pipeline and discard the speculative trials
+	{
+		lock_guard<mutex> guard(finished_lock);
+		limit = committed;
+		finished_change.notify_all();
+	}
+	generated.close();
+	generator.join();
+	for (thread & t : solvers)
+		t.join();
+	for (auto & entry : finished)
+		delete entry.second;
+
+	// Advance the main RNG past the seeds that were used
+	rand_main->skip(committed);
+
+	return status;
+}
+
+/*
+Generates a trial's instance from its seed, or loads it from the cache if it was generated before.  Returns 0 if successful, the reason that an earlier run rejected the instance (which is then skipped), or a negative value if NETGEN failed.
+*/
+int generate_trial(Workspace & ws, int m, int multi, double fraction, int type)
+{
+	ws.netgen_args = netgen_arguments(ws.trial.seed, m, multi, fraction, type);
+	ws.cached_reject = false;
+	int reason = (cache != nullptr ? cache->load_rejection(ws.netgen_args) : 0);
+	if (reason > 0)
+	{
+		ws.log << "\nRejected (" << reject_names[reason] << ") in an earlier run.  Creating a different instance.\n";
+		ws.cached_reject = true;
+		return reason;
+	}
+	if (cache != nullptr && cache->load_instance(ws.netgen_args, ws.inst))
+	{
+		ws.log << "\nLoaded instance from cache.\n";
+		return 0;
+	}
+	ws.log << "\nCalling NETGEN... ";
+	if (call_netgen(ws.netgen_args, ws.inst) != 0) // call NETGEN, and move on only if it worked
+		return -1;
+	ws.log << "Succsessful!\n";
+	if (cache != nullptr)
+		cache->store_instance(ws.netgen_args, ws.inst);
+	return 0;
+}
+
+/*
+Solves a generated trial with every method, filling the trial's statistics.  The network check and the LP come first, since either can prove the MILP infeasible far more cheaply than the MILP solver.  RR comes next, and the MILP last, starting from the RR solutions with the best of them as a cutoff.  The CPLEX models are all built from one incidence matrix (see trial_matrix()).  Returns 0 if successful, or the reason (REJECT_*) that the instance was rejected, so that a different instance should be created.  Rejections are remembered in the cache, except for solver errors.
+*/
+int solve_trial(Workspace & ws)
+{
+	int reason = screen_trial(ws);
+	if (reason == 0)
+	{
+		// RR Trials, whose solutions give the MILP a head start
+		call_rr(ws.inst, ws.trial.lp, ws.trial.seed, ws.trial.rr, ws.log, ws);
+
+		ws.log << "\nSolving MILP... ";
+		int output = call_milp(ws.inst, ws.trial.milp, ws.trial.rr, trial_matrix(ws)); // call MILP solver, and move on only if it worked
+		if (output == SOLVE_INFEASIBLE)
+		{
+			ws.log << "MILP infeasible.  Creating a different instance.\n";
+			reason = REJECT_MILP;
+		}
+		else if (output != 0)
+		{
+			ws.log << "MILP solver failed.  Creating a different instance.\n";
+			reason = REJECT_ERROR;
+		}
+		else
+			ws.log << "Successful!\n";
+	}
+	delete ws.matrix; // the trial waits for its commit long after it's solved, so don't hold on to the matrix until then
+	ws.matrix = nullptr;
+	if (reason > 0)
+	{
+		if (cache != nullptr && reason != REJECT_ERROR) // only proven infeasibility is remembered, so that a rerun tries a failed instance again
+			cache->store_rejection(ws.netgen_args, reason);
+		return reason;
+	}
+	return 0;
+}
+
+/*
+Checks a trial's instance for a feasible flow in its base network, and then solves its LP relaxation (or loads it from the cache).  Returns 0 if both succeed, or the reason (REJECT_*) that the instance was rejected (REJECT_ERROR if the LP solver failed without proving infeasibility).
+*/
+int screen_trial(Workspace & ws)
+{
+	// A network with no feasible flow can't have a feasible MILP, so don't bother solving it
+	PhaseTimer timer(PHASE_SCREEN);
+	bool feasible = network_feasible(ws.inst);
+	timer.stop();
+	if (!feasible)
+	{
+		ws.log << "\nNetwork infeasible.  Creating a different instance.\n";
+		return REJECT_NETWORK;
+	}
+
+	ws.log << "\nSolving LP... ";
+	if (cache != nullptr && cache->load_lp(ws.netgen_args, ws.inst, ws.trial.lp))
+		ws.log << "Loaded from cache.\n";
+	else
+	{
+		int output = call_lp(ws.inst, ws.trial.lp, ws);
+		if (output == SOLVE_INFEASIBLE) // an infeasible relaxation means an infeasible MILP
+		{
+			ws.log << "LP infeasible.  Creating a different instance.\n";
+			return REJECT_LP;
+		}
+		if (output != 0)
+		{
+			ws.log << "LP solver failed.  Creating a different instance.\n";
+			return REJECT_ERROR;
+		}
+		if (cache != nullptr)
+			cache->store_lp(ws.netgen_args, ws.inst, ws.trial.lp);
+		ws.log << "Successful!\n";
+	}
 	return 0;
 }
 
 /*
-Calls NETGEN to generate a network with the specified variable parameters.  Returns the output of the NETGEN program (0 if successful). [seed] [node count] [arcs per node] [interdependencies per sink] [parent type]
+Adds a committed trial to the sweep totals: its rejection, if any, and the time it spent on the MILP or on the checks that rejected it.
+*/
+void count_trial(const Workspace & ws)
+{
+	const PhaseTimes & phases = ws.trial.phases;
+	double milp_time = phases.seconds[PHASE_MILP_BUILD] + phases.seconds[PHASE_MILP_EXTRACT] + phases.seconds[PHASE_MILP_SOLVE] + phases.seconds[PHASE_MILP_RESULTS];
+	double screen_time = phases.seconds[PHASE_SCREEN] + phases.seconds[PHASE_LP_BUILD] + phases.seconds[PHASE_LP_EXTRACT] + phases.seconds[PHASE_LP_SOLVE] + phases.seconds[PHASE_LP_RESULTS];
+	if (ws.rc > 0 && ws.cached_reject)
+	{
+		totals.cached_rejects++;
+		return;
+	}
+	if (ws.rc == 0 || ws.rc == REJECT_MILP)
+	{
+		totals.milp_solves++;
+		totals.milp_seconds += milp_time;
+	}
+	if (ws.rc == REJECT_NETWORK)
+		totals.network_rejects++;
+	else if (ws.rc == REJECT_LP)
+		totals.lp_rejects++;
+	else if (ws.rc == REJECT_MILP)
+		totals.infeasible_milps++;
+	else if (ws.rc == REJECT_ERROR)
+		totals.solver_errors++;
+	if (ws.rc == REJECT_NETWORK || ws.rc == REJECT_LP)
+		totals.screen_seconds += screen_time;
+}
+
+/*
+Reports how many instances the network check and the LP rejected, and estimates the MILP time that they saved: each rejected instance is taken to cost as much as the average MILP that was solved, less the time spent screening it.
+*/
+void report_screen(ostream & out)
+{
+	int screened = totals.network_rejects + totals.lp_rejects;
+	double average = (totals.milp_solves > 0 ? totals.milp_seconds / totals.milp_solves : 0);
+	out << totals.network_rejects << " networks with no feasible flow and " << totals.lp_rejects << " infeasible LPs rejected before the MILP.\n";
+	out << "At the average MILP time of " << average << " s, this saved about " << screened * average - totals.screen_seconds << " s (" << totals.screen_seconds << " s spent screening them).\n";
+	if (totals.cached_rejects > 0)
+		out << totals.cached_rejects << " seeds skipped as rejected in an earlier run.\n";
+	if (totals.solver_errors > 0)
+		out << totals.solver_errors << " instances skipped because a solver failed without an answer (not cached, so a rerun tries them again).\n";
+}
+
+/*
+Writes a trial's row of results: seed, node count, arc count, interdependency count, parent type, MILP and LP cost/time, and finally cost/time/tries for each RR variant.
+*/
+void write_trial(ofstream & outfile, const Trial & trial, int m, int multi, double fraction, int type)
+{
+	outfile << trial.seed << '\t' << m << '\t' << multi * m << '\t';
+	if (type == 0)
+		outfile << ceil(fraction * ceil(0.2 * m));
+	else
+		outfile << ceil(fraction * multi * m);
+	outfile << '\t' << type << '\t' << trial.milp.objective << '\t' << trial.milp.time << '\t' << trial.lp.objective << '\t' << trial.lp.time;
+	for (int k = 0; k < rr_count; k++)
+		outfile << '\t' << trial.rr[k].objective << '\t' << trial.rr[k].time << '\t' << trial.rr[k].tries;
+	outfile << '\n';
+}
+
+/*
+Writes a trial's row of phase times, alongside its row of results: seed, followed by the seconds spent in each phase, in the order of Timer.h.  The times of parallel RR attempts are added up over their threads.
 */
-int call_netgen(long rng_seed, int NODES, int d, double r, int PARENT)
+void write_phases(ofstream & phasefile, const Trial & trial)
 {
-	const int max_tries = 500; // maximum number of times to try calling NETGEN
-	int counter = 0;
-	int return_val;
+	phasefile << trial.seed;
+	for (int p = 0; p < PHASE_COUNT; p++)
+		phasefile << '\t' << trial.phases.seconds[p];
+	phasefile << '\n';
+}
 
+/*
+Fills in the full NETGEN argument vector for the specified variable parameters: [seed] [node count] [arcs per node] [interdependencies per sink] [parent type]
+*/
+vector<long> netgen_arguments(long rng_seed, int NODES, int d, double r, int PARENT)
+{
 	int SOURCES = ceil(0.2 * NODES);
 	int SINKS = ceil(0.2 * NODES);
 	int DENSITY = d * NODES;
@@ -740,84 +630,138 @@ int call_netgen(long rng_seed, int NODES, int d, double r, int PARENT)
 	else
 		INTER = ceil(r * DENSITY);
 
-	string netgen_base = "..\\Netgen"; // replace the ".." with the necessary file path
-
 	/*
-	NETGEN arguments (17): [file name] [seed] [node count] [source count] [sink count] [arc count] [min arc cost] [max arc cost] [total supply] [trans sources] [trans sinks] [% max cost skeleton arcs] [% capacitated skeleton arcs] [min capacity] [max capacity] [0/1 for parent nodes/arcs] [interdependency count]
+	NETGEN arguments (16): [seed] [node count] [source count] [sink count] [arc count] [min arc cost] [max arc cost] [total supply] [trans sources] [trans sinks] [% max cost skeleton arcs] [% capacitated skeleton arcs] [min capacity] [max capacity] [0/1 for parent nodes/arcs] [interdependency count]
 	*/
-	string netgen_args = ' ' + netgen_file_name + ' ' + to_string(rng_seed) + ' ' + to_string(NODES) + ' ' + to_string(SOURCES) + ' '
-		+ to_string(SINKS) + ' ' + to_string(DENSITY) + ' ' + to_string(MINCOST) + ' ' + to_string(MAXCOST) + ' ' + to_string(TOTSUPPLY)
-		+ ' ' + to_string(TSOURCES) + ' ' + to_string(TSINKS) + ' ' + to_string(HICOST) + ' ' + to_string(CAPACITATED) + ' '
-		+ to_string(MINCAP) + ' ' + to_string(MAXCAP) + ' ' + to_string(PARENT) + ' ' + to_string(INTER);
-	string netgen_full = netgen_base + netgen_args;
-	const char * n1 = netgen_full.c_str();
+	return { rng_seed, NODES, SOURCES, SINKS, DENSITY, MINCOST, MAXCOST, TOTSUPPLY, TSOURCES, TSINKS, HICOST, CAPACITATED, MINCAP, MAXCAP, PARENT, INTER };
+}
 
+/*
+Calls NETGEN to generate a network from a full argument vector (see netgen_arguments()), storing it in the given instance.  Returns the output of NETGEN (0 if successful).
+*/
+int call_netgen(const vector<long> & args, Instance & inst)
+{
+	Netgen * gen = new Netgen(args[0], args[1], args[2], args[3], args[4], args[5], args[6], args[7], args[8], args[9], args[10], args[11],
+		args[12], args[13], args[14], args[15]);
+	int return_val = gen->generate(inst);
+	delete gen;
+
+	if (return_val != 0)
+		Netgen::error_message(return_val);
 	return return_val;
 }
 
 /*
-Calls program to solve the MILP version of the current .min file.  Returns the output of the program (0 if successful). Requires no input. Outputs objective and time.
+Returns the incidence matrix of a trial's instance, building it the first time it's needed.  Only the worker solving the trial touches it.
 */
-int call_milp()
+const NetworkMatrix& trial_matrix(Workspace & ws)
 {
-	string milp_base = "..\\MilpSolver"; // replace the ".." with the necessary file path
-	/*
-	MILP solver arguments (2): [input file name] [output file name]
-	*/
-	string milp_args = ' ' + netgen_file_name + ' ' + temp_file_name;
-	string milp_full = milp_base + milp_args;
-	const char * n1 = milp_full.c_str();
-
-	return system(n1);
+	if (ws.matrix == nullptr)
+		ws.matrix = new NetworkMatrix(ws.inst);
+	return *ws.matrix;
 }
 
 /*
-Calls program to solve the LP version of the current .min file.  Returns the output of the program (0 if successful). Requires no input. Outputs objective, time, and the fraction of each parents'/childs' capacity used
+Solves the MILP version of the current instance, starting from the RR results (one per variant) that found a solution, with its model built from the trial's incidence matrix.  Returns the output of the solver (0 if successful). Fills in objective and time.
 */
-int call_lp()
+int call_milp(const Instance & inst, Result & res, const Result * rr, const NetworkMatrix & matrix)
 {
-	string lp_base = "..\\LpSolver"; // replace the ".." with the necessary file path
-	/*
-	LP solver arguments (4): [input file name] [output file name] [parent flow file name] [child flow file name]
-	*/
-	string lp_args = ' ' + netgen_file_name + ' ' + temp_file_name + ' ' + parent_flow_name + ' ' + child_flow_name;
-	string lp_full = lp_base + lp_args;
-	const char * n1 = lp_full.c_str();
+	vector<Result> starts(rr, rr + rr_count);
+	return solve_milp(inst, res, cplex_threads, &starts, milp_formulation, &matrix);
+}
 
-	return system(n1);
+/*
+Solves the LP version of the current instance, with CPLEX (from the trial's incidence matrix) or natively (see lp_engine).  Returns the output of the solver (0 if successful). Fills in objective, time, and the fraction of each parents'/childs' capacity used
+*/
+int call_lp(const Instance & inst, Result & res, Workspace & ws)
+{
+	if (lp_engine == LP_NATIVE)
+		return solve_lp_native(inst, res);
+	return solve_lp(inst, res, cplex_threads, &trial_matrix(ws));
 }
 
 /*
-Calls program to solve a specified RR version of the current .min file. Repeatedly attempts to solve the problem until either finding the solution or reaching the cutoff. Returns the number of tries if successful, or a negative value if not. Input is a random seed to use to initialize the randomized selection, the number of the desired RR method (1 for RRC, 2 for RRP, 3 for RRF), and finally a bound used to define the RR rule (the value of epsilon to restrict probabilities to the interval [epsilon,1-epsilon], so for example RRP1 uses a bound of 0.01). Outputs objective, time, and number of tries required
+Solves every RR version of the current instance, in the order of rr_variants. Each version repeatedly attempts to solve the problem until either finding the solution or reaching the cutoff, and all of them are solved on the same models. Returns the number of versions solved. Input is the instance, its LP results, a random seed to use to initialize the randomized selection, an array of results (one per version), a stream for progress messages, and finally the trial's workspace (for its incidence matrix). Fills in objective, time, and number of tries required for each version, or -999 for versions that timed out
 */
-int call_rr(long seed, int mode, double bound)
+int call_rr(const Instance & inst, const Result & lp, long seed, Result * res, ostream & log, Workspace & ws)
 {
-	string rr_base = "..\\RrSolver"; // replace the ".." with the necessary file path
-	NetgenRandom * rand_sub = new NetgenRandom(seed); // random number to use in the output file name
-	int count = 0;
-	int output = -1;
-	
-	// Loop until solving the problem or reaching the cutoff
-	while (output != 0 && count < cutoff)
+	vector<Result> variant_res;
+	const NetworkMatrix * matrix = (rr_engine == RR_CPLEX ? &trial_matrix(ws) : nullptr); // the native engine doesn't use it
+	int output = solve_rr_variants(inst, lp.parent_flow, lp.child_flow, seed, rr_variants, cutoff, variant_res, cplex_threads, rr_engine, &lp, rr_parallel, matrix);
+
+	for (int k = 0; k < rr_count; k++)
 	{
-		cout << "\nAttempt " << count + 1 << '\n';
-
-		/*
-		RR solver arguments (5): [input file name] [output file name] [parent flow file name] [child flow file name] [seed] [bound]
-		*/
-		string rr_args = ' ' + netgen_file_name + ' ' + temp_file_name + ' ' + parent_flow_name + ' ' + child_flow_name + ' '
-			+ to_string(rand_sub->random(1, 99999999)) + ' ' + to_string(mode) + ' ' + to_string(bound);
-		string rr_full = rr_base + rr_args;
-		const char * n1 = rr_full.c_str();
-
-		output = system(n1);
-		count++;
+		res[k] = variant_res[k];
+		log << "\nSolving " << rr_names[k] << "... ";
+		for (int i = 0; i < res[k].tries; i++)
+			log << "\nAttempt " << i + 1 << '\n';
+		if (res[k].time >= 0)
+			log << "Successful!\n";
+		else
+		{
+			// RR timed out
+			res[k].objective = res[k].time = -999;
+			res[k].tries = -999;
+			log << "Timed out.\n";
+		}
 	}
+	return output;
+}
 
-	delete rand_sub;
+/*
+Saves the sweep's position to the checkpoint file, replacing the old one only once the new one is completely written.  The file is plain text, one "name value" line per field of the checkpoint.  Returns 0 if successful.
+*/
+int write_checkpoint(const Checkpoint & state)
+{
+	string temp_name = checkpoint_name + ".tmp";
+	ofstream outfile;
+	outfile.open(temp_name);
+	if (outfile.is_open() == false)
+		return -1;
+	outfile << "cell " << state.cell << '\n';
+	outfile << "rng " << state.rng_state << '\n';
+	outfile << "results " << state.result_name << '\n';
+	outfile << "committed " << state.committed << '\n';
+	outfile << "recorded " << state.recorded << '\n';
+	outfile << "results_bytes " << state.results_bytes << '\n';
+	outfile << "phases_bytes " << state.phases_bytes << '\n';
+	outfile << "rejected_bytes " << state.rejected_bytes << '\n';
+	outfile.precision(17); // enough to read back exactly
+	const SweepTotals & t = state.totals;
+	outfile << "totals " << t.netgen_restarts << ' ' << t.infeasible_milps << ' ' << t.network_rejects << ' ' << t.lp_rejects << ' ' << t.cached_rejects << ' '
+		<< t.milp_solves << ' ' << t.milp_seconds << ' ' << t.screen_seconds << ' ' << t.solver_errors << '\n';
+	outfile.flush();
+	bool ok = outfile.good();
+	outfile.close();
+	error_code ec;
+	if (ok)
+		filesystem::rename(temp_name, checkpoint_name, ec); // replaces the old checkpoint in one step
+	if (ok == false || ec)
+	{
+		filesystem::remove(temp_name, ec);
+		return -1;
+	}
+	return 0;
+}
 
-	if (output != 0)
-		return -1; // timed out
-	else
-		return count; // number of tries before success
-}
\ No newline at end of file
+/*
+Reads the checkpoint file written by write_checkpoint().  Returns 0 if successful.
+*/
+int read_checkpoint(Checkpoint & state)
+{
+	ifstream infile;
+	infile.open(checkpoint_name);
+	if (infile.is_open() == false)
+		return -1;
+	string tag[9];
+	infile >> tag[0] >> state.cell >> tag[1] >> state.rng_state >> tag[2] >> state.result_name >> tag[3] >> state.committed >> tag[4] >> state.recorded
+		>> tag[5] >> state.results_bytes >> tag[6] >> state.phases_bytes >> tag[7] >> state.rejected_bytes;
+	SweepTotals & t = state.totals;
+	infile >> tag[8] >> t.netgen_restarts >> t.infeasible_milps >> t.network_rejects >> t.lp_rejects >> t.cached_rejects >> t.milp_solves >> t.milp_seconds >> t.screen_seconds;
+	if (!infile || tag[0] != "cell" || tag[1] != "rng" || tag[2] != "results" || tag[3] != "committed" || tag[4] != "recorded" || tag[5] != "results_bytes"
+		|| tag[6] != "phases_bytes" || tag[7] != "rejected_bytes" || tag[8] != "totals")
+		return -1;
+	if (!(infile >> t.solver_errors))
+		t.solver_errors = 0; // checkpoints from before solver errors were counted
+	return 0;
+}
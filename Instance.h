@@ -0,0 +1,44 @@
+#pragma once
+#include <vector>
+using namespace std;
+
+/*
+In-memory version of a NETGEN .min file, so that an instance can be passed from the generator to the solvers without going through a temporary file.  All node and arc IDs are zero-indexed, matching the solvers' internal arrays.
+*/
+struct Instance
+{
+	long NODES;
+	long SOURCES;
+	long SINKS;
+	long DENSITY;
+	long INTER;
+	int PARENT; // 0 if parents are sink nodes, 1 if parents are arcs
+	vector<long> b; // node supply (demand) values
+	vector<long> u; // arc capacities
+	vector<long> c; // arc costs
+	vector<unsigned long> tail;
+	vector<long> head; // negative head means we're ignoring it
+	vector<unsigned long> parent; // parent arcs
+	vector<unsigned long> child; // child arcs
+};
+
+// Output of a solver that has proven the instance infeasible.  Any other failure (a time or memory limit, or a numerical problem) gives a negative output, since it proves nothing about the instance.
+#define SOLVE_INFEASIBLE 1
+
+/*
+Results of a single solver call, replacing the old temporary results file.  Failed solves leave the objective and time at -999, as the solvers always have.
+*/
+struct Result
+{
+	double objective = -999;
+	double time = -999;
+	double load = 0; // average fullness of all arc flows
+	int tries = 0; // number of RR attempts used
+	long seed = 0; // seed of the successful RR attempt
+	vector<double> attempt_time; // solve time of each RR attempt, in order (RR only)
+	vector<double> parent_flow; // fraction of each parent's capacity used (LP only)
+	vector<double> child_flow; // fraction of each child's capacity used (LP only)
+	vector<double> flow; // flow on every arc (LP, or the successful RR attempt)
+	vector<int> arc_status; // optimal basis status of every arc variable (LP only, see LpBasis.h)
+	vector<int> node_status; // optimal basis status of every node balance row (LP only)
+};
@@ -0,0 +1,349 @@
+/*
+On-disk cache of instances and LP solutions (see InstanceCache.h).  The LP files are plain text:
+	k followed by the NETGEN arguments
+	o OBJECTIVE TIME LOAD
+	i INTER DENSITY NODES
+followed by one "p PARENT CHILD" line per interdependency (the fractions of capacity used), one "x FLOW STATUS" line per arc and one "r STATUS" line per node, in ID order.  Rejection files are just the "k" line and an "r REASON" line.
+*/
+
+#include <fstream>
+#include <cstdio>
+#include <filesystem>
+#include <algorithm>
+#include "InstanceCache.h"
+#include "BinFile.h"
+#include "Timer.h"
+using namespace std;
+
+InstanceCache::InstanceCache(string dir, unsigned long long max_bytes)
+{
+	directory = dir;
+	limit = max_bytes;
+	total = 0;
+	clock = 0;
+	instance_hits = instance_misses = lp_hits = lp_misses = rejection_hits = evictions = 0;
+}
+
+// Creates the cache directory if it doesn't exist, and records the size and age of every file already in it (throwing away any leftover temporary files).  Returns 0 if successful.
+int InstanceCache::open()
+{
+	error_code ec;
+	filesystem::create_directories(directory, ec);
+	if (filesystem::is_directory(directory, ec) == false)
+		return -1;
+
+	vector<pair<filesystem::file_time_type, string>> found;
+	for (const filesystem::directory_entry & entry : filesystem::directory_iterator(directory, ec))
+	{
+		if (entry.is_regular_file(ec) == false)
+			continue;
+		string name = entry.path().filename().string();
+		string extension = entry.path().extension().string();
+		if (extension == ".tmp")
+			filesystem::remove(entry.path(), ec);
+		else if (extension == ".bin" || extension == ".lp" || extension == ".rej")
+			found.push_back(make_pair(entry.last_write_time(ec), name));
+	}
+	if (ec)
+		return -1;
+
+	// Oldest first, so that the least recently used files are evicted first
+	sort(found.begin(), found.end());
+	lock_guard<mutex> guard(lock);
+	for (auto & file : found)
+		add_file(file.second);
+	return 0;
+}
+
+// Hashes a NETGEN argument vector (and the cache version) with 64-bit FNV-1a, taking each argument as 8 little-endian bytes.
+uint64_t InstanceCache::key(const vector<long> & args)
+{
+	uint64_t hash = 14695981039346656037ULL;
+	auto mix = [&hash](long long value)
+	{
+		for (int i = 0; i < 8; i++)
+		{
+			hash ^= (uint64_t)(value >> (8 * i)) & 0xff;
+			hash *= 1099511628211ULL;
+		}
+	};
+	mix(CACHE_VERSION);
+	for (long arg : args)
+		mix(arg);
+	return hash;
+}
+
+// Name of the cache file with the given extension for an argument vector.
+string InstanceCache::path(const vector<long> & args, string extension) const
+{
+	char name[17];
+	snprintf(name, sizeof(name), "%016llx", (unsigned long long)key(args));
+	return directory + "/" + name + extension;
+}
+
+// Marks a file as just used, both in memory and on disk.  Expects the lock to be held.
+void InstanceCache::touch(string name)
+{
+	auto it = files.find(name);
+	if (it == files.end())
+		return;
+	recency.erase(make_pair(it->second.second, name));
+	it->second.second = ++clock;
+	recency.insert(make_pair(it->second.second, name));
+	error_code ec;
+	filesystem::last_write_time(directory + "/" + name, filesystem::file_time_type::clock::now(), ec);
+}
+
+// Adds a file to the records as the most recently used one.  Expects the lock to be held.
+void InstanceCache::add_file(string name)
+{
+	forget(name);
+	error_code ec;
+	unsigned long long size = filesystem::file_size(directory + "/" + name, ec);
+	if (ec)
+		return;
+	files[name] = make_pair(size, ++clock);
+	recency.insert(make_pair(clock, name));
+	total += size;
+}
+
+// Drops a file from the records (but not from the disk).  Expects the lock to be held.
+void InstanceCache::forget(string name)
+{
+	auto it = files.find(name);
+	if (it == files.end())
+		return;
+	total -= it->second.first;
+	recency.erase(make_pair(it->second.second, name));
+	files.erase(it);
+}
+
+// Deletes the least recently used files until the cache is back under its size limit, always keeping the newest file.  Expects the lock to be held.
+void InstanceCache::evict()
+{
+	while (total > limit && recency.size() > 1)
+	{
+		string oldest = recency.begin()->second;
+		forget(oldest);
+		remove((directory + "/" + oldest).c_str());
+		evictions++;
+	}
+}
+
+// Loads a cached instance.  Returns true on a hit.
+bool InstanceCache::load_instance(const vector<long> & args, Instance & inst)
+{
+	string file_name = path(args, ".bin");
+	string name = file_name.substr(directory.size() + 1);
+	{
+		lock_guard<mutex> guard(lock);
+		if (files.count(name) == 0)
+		{
+			instance_misses++;
+			return false;
+		}
+	}
+
+	// The file may have been evicted in the meantime, in which case this is a miss after all
+	bool hit = (read_bin(file_name, inst) == 0 && inst.NODES == args[1] && inst.PARENT == args[14]);
+	lock_guard<mutex> guard(lock);
+	if (hit)
+	{
+		instance_hits++;
+		touch(name);
+	}
+	else
+		instance_misses++;
+	return hit;
+}
+
+// Writes a file under a temporary name with the given writer, then renames it into place.  Returns true if successful.
+template <class Writer>
+static bool write_atomically(string file_name, Writer writer)
+{
+	string temp_name = file_name + ".tmp";
+	if (writer(temp_name) != 0)
+	{
+		remove(temp_name.c_str());
+		return false;
+	}
+	error_code ec;
+	filesystem::rename(temp_name, file_name, ec);
+	if (ec)
+	{
+		remove(temp_name.c_str());
+		return false;
+	}
+	return true;
+}
+
+// Stores a generated instance.
+void InstanceCache::store_instance(const vector<long> & args, const Instance & inst)
+{
+	string file_name = path(args, ".bin");
+	if (write_atomically(file_name, [&](string temp_name) { return write_bin(temp_name, inst); }) == false)
+		return;
+
+	lock_guard<mutex> guard(lock);
+	add_file(file_name.substr(directory.size() + 1));
+	evict();
+}
+
+// Loads a cached LP solution for the instance.  Returns true on a hit.
+bool InstanceCache::load_lp(const vector<long> & args, const Instance & inst, Result & res)
+{
+	string file_name = path(args, ".lp");
+	string name = file_name.substr(directory.size() + 1);
+	{
+		lock_guard<mutex> guard(lock);
+		if (files.count(name) == 0)
+		{
+			lp_misses++;
+			return false;
+		}
+	}
+
+	bool hit = false;
+	{
+		PhaseTimer timer(PHASE_PARSE);
+		ifstream infile;
+		infile.open(file_name);
+		string tag;
+		long value, inter, arcs, nodes;
+		hit = (infile >> tag) && tag == "k";
+		for (size_t i = 0; hit && i < args.size(); i++)
+			hit = (infile >> value) && value == args[i];
+		hit = hit && (infile >> tag >> res.objective >> res.time >> res.load) && tag == "o";
+		hit = hit && (infile >> tag >> inter >> arcs >> nodes) && tag == "i" && inter == inst.INTER && arcs == inst.DENSITY && nodes == inst.NODES;
+		if (hit)
+		{
+			res.parent_flow.resize(inter);
+			res.child_flow.resize(inter);
+			res.flow.resize(arcs);
+			res.arc_status.resize(arcs);
+			res.node_status.resize(nodes);
+		}
+		for (long i = 0; hit && i < inter; i++)
+			hit = (infile >> tag >> res.parent_flow[i] >> res.child_flow[i]) && tag == "p";
+		for (long i = 0; hit && i < arcs; i++)
+			hit = (infile >> tag >> res.flow[i] >> res.arc_status[i]) && tag == "x";
+		for (long i = 0; hit && i < nodes; i++)
+			hit = (infile >> tag >> res.node_status[i]) && tag == "r";
+	}
+
+	if (hit == false)
+		res = Result(); // don't leave a partly read solution behind
+	lock_guard<mutex> guard(lock);
+	if (hit)
+	{
+		lp_hits++;
+		touch(name);
+	}
+	else
+		lp_misses++;
+	return hit;
+}
+
+// Stores the LP solution of an instance.
+void InstanceCache::store_lp(const vector<long> & args, const Instance & inst, const Result & res)
+{
+	if ((long)res.parent_flow.size() != inst.INTER || (long)res.child_flow.size() != inst.INTER || (long)res.flow.size() != inst.DENSITY
+		|| (long)res.arc_status.size() != inst.DENSITY || (long)res.node_status.size() != inst.NODES)
+		return;
+
+	string file_name = path(args, ".lp");
+	auto writer = [&](string temp_name)
+	{
+		PhaseTimer timer(PHASE_WRITE);
+		ofstream outfile;
+		outfile.open(temp_name);
+		if (outfile.is_open() == false)
+			return -1;
+		outfile.precision(17); // enough to read back exactly
+		outfile << 'k';
+		for (long arg : args)
+			outfile << ' ' << arg;
+		outfile << "\no " << res.objective << ' ' << res.time << ' ' << res.load << '\n';
+		outfile << "i " << inst.INTER << ' ' << inst.DENSITY << ' ' << inst.NODES << '\n';
+		for (long i = 0; i < inst.INTER; i++)
+			outfile << "p " << res.parent_flow[i] << ' ' << res.child_flow[i] << '\n';
+		for (long i = 0; i < inst.DENSITY; i++)
+			outfile << "x " << res.flow[i] << ' ' << res.arc_status[i] << '\n';
+		for (long i = 0; i < inst.NODES; i++)
+			outfile << "r " << res.node_status[i] << '\n';
+		bool ok = outfile.good();
+		outfile.close();
+		return ok ? 0 : -1;
+	};
+	if (write_atomically(file_name, writer) == false)
+		return;
+
+	lock_guard<mutex> guard(lock);
+	add_file(file_name.substr(directory.size() + 1));
+	evict();
+}
+
+// Loads the reason that an instance was rejected.  Returns 0 if there is no cached rejection.
+int InstanceCache::load_rejection(const vector<long> & args)
+{
+	string file_name = path(args, ".rej");
+	string name = file_name.substr(directory.size() + 1);
+	{
+		lock_guard<mutex> guard(lock);
+		if (files.count(name) == 0)
+			return 0;
+	}
+
+	ifstream infile;
+	infile.open(file_name);
+	string tag;
+	long value;
+	int reason = 0;
+	bool hit = (infile >> tag) && tag == "k";
+	for (size_t i = 0; hit && i < args.size(); i++)
+		hit = (infile >> value) && value == args[i];
+	hit = hit && (infile >> tag >> reason) && tag == "r" && reason > 0;
+
+	lock_guard<mutex> guard(lock);
+	if (hit == false)
+		return 0;
+	rejection_hits++;
+	touch(name);
+	return reason;
+}
+
+// Stores the reason that an instance was rejected.
+void InstanceCache::store_rejection(const vector<long> & args, int reason)
+{
+	string file_name = path(args, ".rej");
+	auto writer = [&](string temp_name)
+	{
+		ofstream outfile;
+		outfile.open(temp_name);
+		if (outfile.is_open() == false)
+			return -1;
+		outfile << 'k';
+		for (long arg : args)
+			outfile << ' ' << arg;
+		outfile << "\nr " << reason << '\n';
+		bool ok = outfile.good();
+		outfile.close();
+		return ok ? 0 : -1;
+	};
+	if (write_atomically(file_name, writer) == false)
+		return;
+
+	lock_guard<mutex> guard(lock);
+	add_file(file_name.substr(directory.size() + 1));
+	evict();
+}
+
+// Prints the hit and miss counts of each kind of entry, the number of evictions, and the cache's current size.
+void InstanceCache::print_stats(ostream & out)
+{
+	lock_guard<mutex> guard(lock);
+	out << "Instance cache: " << instance_hits << " hits, " << instance_misses << " misses\n";
+	out << "LP cache: " << lp_hits << " hits, " << lp_misses << " misses\n";
+	out << "Rejection cache: " << rejection_hits << " hits\n";
+	out << evictions << " files evicted, " << files.size() << " files (" << total << " bytes) in " << directory << '\n';
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <mutex>
+#include <cstdint>
+#include <ostream>
+#include "Instance.h"
+using namespace std;
+
+#define CACHE_VERSION 1 // part of every key, so that changing the generator or the file formats can retire old entries
+
+/*
+An on-disk cache of generated instances and their LP solutions, so that rerunning a sweep (after a crash, or with different RR rules) doesn't regenerate the same networks or re-solve their LPs.  Entries are addressed by a 64-bit FNV-1a hash of the NETGEN argument vector (which includes the seed): the instance is kept as "<key>.bin" in the binary format (see BinFile.h), and the LP result as "<key>.lp", a text file that starts with the full argument vector so that a hash collision can't return the wrong solution.  A cached LP keeps the objective, time, load, parent/child fractions, flows and basis of the original solve.  Instances that were rejected (because they can't have a feasible MILP) are remembered in "<key>.rej", which holds the argument vector and the caller's reason code, so they can be skipped without being generated again.
+
+The cache is bounded by the total size of its files.  Whenever a store takes it over the limit, the least recently used files are deleted; use is tracked through the files' modification times, so the order carries over between runs.  Files are written under a temporary name and renamed once complete, so a crash never leaves a partial entry.  All methods may be called from several threads at once.
+*/
+class InstanceCache
+{
+private:
+	string directory;
+	unsigned long long limit; // maximum total size of the cached files, in bytes
+	unsigned long long total; // current total size
+	long long clock; // counts uses, to order the files by recency
+	map<string, pair<unsigned long long, long long>> files; // size and last use of each file, by name
+	set<pair<long long, string>> recency; // (last use, name) of each file, oldest first
+	long instance_hits, instance_misses, lp_hits, lp_misses, rejection_hits, evictions;
+	mutex lock;
+	// methods
+	string path(const vector<long>&, string) const;
+	void touch(string);
+	void add_file(string);
+	void forget(string);
+	void evict();
+	InstanceCache(const InstanceCache&) = delete;
+	InstanceCache& operator=(const InstanceCache&) = delete;
+public:
+	InstanceCache(string, unsigned long long);
+	int open(); // create the directory if needed and take stock of its files; output 0 if it worked, or -1 if not
+	static uint64_t key(const vector<long>&); // hash of a NETGEN argument vector
+	bool load_instance(const vector<long>&, Instance&); // load the instance generated from these arguments, if cached
+	void store_instance(const vector<long>&, const Instance&);
+	bool load_lp(const vector<long>&, const Instance&, Result&); // load the LP solution of the instance generated from these arguments, if cached
+	void store_lp(const vector<long>&, const Instance&, const Result&);
+	int load_rejection(const vector<long>&); // the reason that the instance generated from these arguments was rejected, or 0 if it wasn't (or isn't cached)
+	void store_rejection(const vector<long>&, int);
+	void print_stats(ostream&); // hit and miss counts, evictions and size
+};
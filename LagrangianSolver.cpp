@@ -0,0 +1,288 @@
+/*
+Reads in a specified .min file generated by NETGEN and computes a Lagrangian lower bound on its MILP, along with the best feasible solution found by the primal heuristic along the way (see LagrangianSolver.h).  No general LP solver is needed.  We expect two arguments: the name of the .min file, and the name of the output file, which gets the bound, the time, and the best heuristic objective (-999 if none was found).  Two more are optional: the number of iterations, and the name of a file for the bound trajectory, with one line per iteration giving the bound, the best bound so far, the best heuristic objective so far, the step size, and the time.
+
+A last argument of "-check" also solves the LP relaxation with the side-constrained simplex (see SideSimplex.h) and checks it against the bounds, which needs no CPLEX: the LP solution must satisfy every constraint, its objective must be at least the Lagrangian bound (which can't exceed the LP optimum), and it must be no more than the best heuristic objective (which is feasible for the MILP, so it can't be below the LP optimum).  The results are printed, and the program fails if any check does.
+
+The input may also be a binary instance file (see BinFile.h), which is recognized by its first few bytes.
+
+When compiled with MCNFLI_LIB defined, the main method is left out and the solver is instead called in-process through solve_lagrangian() (see LagrangianSolver.h).
+*/
+
+#include <iostream>
+#include <string>
+#include <fstream>
+#include <chrono>
+#include <cmath>
+#include <vector>
+#include "BinFile.h"
+#include "MinCostFlow.h"
+#include "LagrangianSolver.h"
+#include "SideSimplex.h"
+#include "Timer.h"
+using namespace std;
+
+#ifndef MCNFLI_LIB
+int main(int argc, char* argv[])
+{
+	bool check = false;
+	if (argc >= 4 && string(argv[argc - 1]) == "-check")
+	{
+		check = true;
+		argc--;
+	}
+	if (argc < 3 || argc > 5)
+	{
+		cout << "Expecting the following 2 (4) arguments: [input file] [output file] ([iterations] [trajectory file]), optionally followed by -check\n";
+		return -1;
+	}
+	string input_name = argv[1];
+	string output_name = argv[2];
+	int iterations = LAGRANGE_ITERATIONS;
+	if (argc >= 4)
+		iterations = stoi(argv[3]);
+	if (iterations < 1)
+	{
+		cout << "Number of iterations must be positive\n";
+		return -1;
+	}
+
+	// Try to read in the problem
+	Instance inst;
+	if (read_instance(input_name, inst) != 0)
+	{
+		cout << "Lagrangian solver failed to read in problem file " << input_name << '\n';
+		return -1;
+	}
+
+	// Try to solve the problem
+	Result bound, primal;
+	vector<LagrangianStep> trajectory;
+	if (solve_lagrangian(inst, bound, primal, trajectory, iterations) != 0)
+	{
+		cout << "Network is infeasible (or its costs are too large to solve with), so there is no bound.\n";
+		return -1;
+	}
+
+	// Output the results to a file
+	PhaseTimer timer(PHASE_WRITE);
+	ofstream outfile;
+	outfile.open(output_name);
+	if (outfile.is_open() == false)
+	{
+		cout << "Output file " << output_name << " failed to open.\n";
+		return -1;
+	}
+	outfile << fixed;
+	outfile << bound.objective << '\n' << bound.time << '\n' << primal.objective;
+	outfile.close();
+
+	// Bound trajectory
+	if (argc == 5)
+	{
+		ofstream trajectoryfile;
+		trajectoryfile.open(argv[4]);
+		if (trajectoryfile.is_open() == false)
+		{
+			cout << "Trajectory output file " << argv[4] << " failed to open.\n";
+			return -1;
+		}
+		trajectoryfile << fixed;
+		for (const LagrangianStep & step : trajectory)
+			trajectoryfile << step.bound << '\t' << step.best_bound << '\t' << step.primal << '\t' << step.step << '\t' << step.time << '\n';
+		trajectoryfile.close();
+	}
+	timer.stop();
+
+	// Native LP against the bounds
+	if (check)
+	{
+		Result lp;
+		int output = solve_lp_native(inst, lp);
+		if (output != 0)
+		{
+			cout << (output == SOLVE_INFEASIBLE ? "Native LP is infeasible, but the bound exists.\n" : "Native LP solver failed.\n");
+			return -1;
+		}
+		double violation = lp_violation(inst, lp);
+		double tolerance = 1e-6 * (1 + fabs(lp.objective));
+		cout << fixed << "Native LP: objective " << lp.objective << ", time " << lp.time << ", largest violation " << violation << '\n';
+		cout << "Lagrangian bound " << bound.objective << ", best heuristic objective " << primal.objective << '\n';
+		if (violation > 1e-6 || lp.objective < bound.objective - tolerance || (primal.time >= 0 && lp.objective > primal.objective + tolerance))
+		{
+			cout << "LP and bounds disagree.\n";
+			return -1;
+		}
+		cout << "LP and bounds agree.\n";
+	}
+	if (timing_enabled)
+		thread_phase_times().print(cout);
+	return 0;
+}
+#endif
+
+// Runs the subgradient method, with the heuristic after each subproblem.  Outputs 0 if a bound is found.
+int solve_lagrangian(const Instance & inst, Result & bound, Result & primal, vector<LagrangianStep> & trajectory, int iterations)
+{
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	auto elapsed = [&start]() { return chrono::duration<double>(chrono::steady_clock::now() - start).count(); };
+	bound = Result();
+	primal = Result();
+	trajectory.clear();
+
+	NetworkSimplex subproblem(inst); // network with the adjusted costs
+	NetworkSimplex heuristic(inst); // network with the original costs, under the heuristic's fixings
+	vector<double> lambda(inst.INTER, 0); // multipliers of the parent rows
+	vector<double> mu(inst.INTER, 0); // multipliers of the child rows
+	vector<double> lambda_step(inst.INTER), mu_step(inst.INTER); // projected subgradient
+	vector<double> adjusted(inst.DENSITY);
+	vector<long long> rounded(inst.DENSITY);
+	vector<long> x;
+	vector<char> open(inst.INTER), last_open; // heuristic's choice for each child
+	vector<long> lb(inst.DENSITY, 0), ub(inst.u.begin(), inst.u.end()); // heuristic's bounds
+
+	// Arcs involved in interdependencies, each listed once
+	vector<long> touched;
+	vector<char> listed(inst.DENSITY, 0);
+	for (long i = 0; i < inst.INTER; i++)
+	{
+		for (long arc : { (long)inst.parent[i], (long)inst.child[i] })
+		{
+			if (listed[arc] == 0)
+			{
+				listed[arc] = 1;
+				touched.push_back(arc);
+			}
+		}
+	}
+
+	double best = -INFINITY;
+	double theta = LAGRANGE_THETA;
+	int stall = 0;
+	for (int k = 0; k < iterations; k++)
+	{
+		// Subproblem costs: the multipliers move onto the parent and child arcs, and only those arcs' costs need rounding
+		for (long a = 0; a < inst.DENSITY; a++)
+			adjusted[a] = inst.c[a];
+		for (long i = 0; i < inst.INTER; i++)
+		{
+			adjusted[inst.parent[i]] -= lambda[i];
+			adjusted[inst.child[i]] += mu[i];
+		}
+		double rounding = 0; // most that rounding the costs can lower the subproblem's optimum
+		for (long a = 0; a < inst.DENSITY; a++)
+		{
+			rounded[a] = llround(adjusted[a] * LAGRANGE_SCALE);
+			if (listed[a] == 1)
+				rounding += fabs(adjusted[a] - (double)rounded[a] / LAGRANGE_SCALE) * inst.u[a];
+		}
+		if (subproblem.set_costs(rounded) != 0)
+		{
+			if (k == 0)
+			{
+				bound.time = elapsed();
+				return -1; // the instance's own costs are too large for the network simplex
+			}
+			break; // the multipliers have grown too large, so keep the best bound so far
+		}
+		double flow_cost;
+		if (subproblem.solve(flow_cost) != 0)
+		{
+			if (k == 0)
+			{
+				bound.time = elapsed();
+				return -1; // the costs don't affect feasibility, so this is the network without interdependencies
+			}
+			break; // the simplex gave up on these costs, so keep the best bound so far
+		}
+		subproblem.get_flow(x);
+
+		// Each y[i] is 1 exactly when its cost in the Lagrangian is negative
+		double value = flow_cost / LAGRANGE_SCALE - rounding;
+		double norm = 0;
+		for (long i = 0; i < inst.INTER; i++)
+		{
+			double u_parent = inst.u[inst.parent[i]];
+			double u_child = inst.u[inst.child[i]];
+			double y_cost = mu[i] * u_child - lambda[i] * u_parent;
+			double y = (y_cost < 0 ? 1 : 0);
+			value += lambda[i] * u_parent - mu[i] * u_child + y_cost * y;
+			lambda_step[i] = u_parent - x[inst.parent[i]] - u_parent * y;
+			mu_step[i] = x[inst.child[i]] + u_child * y - u_child;
+			if (lambda[i] <= 0 && lambda_step[i] < 0)
+				lambda_step[i] = 0; // projected onto the nonnegative multipliers
+			if (mu[i] <= 0 && mu_step[i] < 0)
+				mu_step[i] = 0;
+			norm += lambda_step[i] * lambda_step[i] + mu_step[i] * mu_step[i];
+		}
+		if (value > best)
+		{
+			best = value;
+			stall = 0;
+		}
+		else if (++stall >= LAGRANGE_PATIENCE)
+		{
+			theta /= 2;
+			stall = 0;
+		}
+
+		// Heuristic: open the children whose parents the subproblem fills, unless that's the same choice as last time
+		for (long i = 0; i < inst.INTER; i++)
+			open[i] = (x[inst.parent[i]] >= inst.u[inst.parent[i]] ? 1 : 0);
+		if (open != last_open)
+		{
+			last_open = open;
+			for (long arc : touched)
+			{
+				lb[arc] = 0;
+				ub[arc] = inst.u[arc];
+			}
+			for (long i = 0; i < inst.INTER; i++)
+			{
+				if (open[i] == 1)
+					lb[inst.parent[i]] = inst.u[inst.parent[i]]; // an open child needs a full parent
+				else
+					ub[inst.child[i]] = 0; // a closed child carries nothing
+			}
+			for (long arc : touched)
+				heuristic.set_bounds(arc, lb[arc], ub[arc]);
+			double objective;
+			if (heuristic.solve(objective) == 0 && (primal.time < 0 || objective < primal.objective))
+			{
+				primal.objective = objective;
+				primal.time = elapsed();
+				vector<long> flow;
+				heuristic.get_flow(flow);
+				primal.flow.assign(flow.begin(), flow.end());
+				primal.load = 0;
+				for (long a = 0; a < inst.DENSITY; a++)
+					if (inst.u[a] > 0)
+						primal.load += (double)flow[a] / inst.u[a];
+				primal.load /= inst.DENSITY;
+			}
+		}
+
+		// Polyak step toward the best primal objective (or a little above the best bound until there is one)
+		double target = (primal.time >= 0 ? primal.objective : best + 0.01 * fabs(best) + 1);
+		double step = (norm > 0 ? theta * (target - value) / norm : 0);
+		LagrangianStep record;
+		record.bound = value;
+		record.best_bound = best;
+		record.primal = primal.objective;
+		record.step = step;
+		record.time = elapsed();
+		trajectory.push_back(record);
+
+		// A zero subgradient means the multipliers are optimal
+		if (norm == 0 || theta < 1e-4 || (primal.time >= 0 && primal.objective - best <= 1e-6 * (1 + fabs(primal.objective))))
+			break;
+		for (long i = 0; i < inst.INTER; i++)
+		{
+			lambda[i] = max(0.0, lambda[i] + step * lambda_step[i]);
+			mu[i] = max(0.0, mu[i] + step * mu_step[i]);
+		}
+	}
+
+	bound.objective = best;
+	bound.time = elapsed();
+	return 0;
+}
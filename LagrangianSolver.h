@@ -0,0 +1,28 @@
+#pragma once
+#include <vector>
+#include "Instance.h"
+using namespace std;
+
+#define LAGRANGE_ITERATIONS 200 // default limit on subgradient iterations
+#define LAGRANGE_SCALE 10000 // subproblem costs are rounded to multiples of 1/LAGRANGE_SCALE for the integer network simplex
+#define LAGRANGE_THETA 2.0 // starting step size factor
+#define LAGRANGE_PATIENCE 10 // iterations without a better bound before the step size factor is halved
+
+// One iteration of the subgradient method
+struct LagrangianStep
+{
+	double bound; // Lagrangian bound at this iteration's multipliers
+	double best_bound; // best bound so far
+	double primal; // best heuristic objective so far (-999 if none yet)
+	double step; // step size taken from this iteration's multipliers
+	double time; // seconds since the start
+};
+
+/*
+Lower bounds for the MILP without a general LP solver.  Both rows of each interdependency (in their compact form, as in MILP_COMPACT: x[parent] + u[parent]*y[i] >= u[parent] and x[child] + u[child]*y[i] <= u[child]) are dualized without dividing through by the capacities, so that an arc with no capacity needs no special case, which leaves a pure min-cost flow problem with adjusted costs on the parent and child arcs, solved by the native network simplex (see MinCostFlow.h), plus a choice of y[i] for each interdependency made from the sign of its cost.  The multipliers are updated by projected subgradient steps with Polyak's step size, aimed at the best primal objective found so far; the step size factor is halved whenever the bound stops improving.  Since the subproblem has integral extreme points, the bound approaches the LP relaxation's objective.
+
+The network simplex needs integer costs, so the subproblem's costs are rounded to multiples of 1/LAGRANGE_SCALE, and the most that the rounding can have gained is subtracted from each bound, so every bound reported is valid.  Each subproblem's flow also seeds a primal heuristic: a child is opened wherever the subproblem fills its parent, and closed otherwise, and the network is solved again with the original costs under those fixings, which gives a feasible MILP solution whenever the fixings leave a feasible flow.
+
+Fills the first result with the best bound and the total time, and the second with the best heuristic solution (objective, load, arc flows, and the time at which it was found), whose objective and time are left at -999 if none was found.  Also fills one step per iteration.  Stops after the given number of iterations, once the bound meets the best heuristic objective, or once the step size factor becomes negligible.  Returns 0 if a bound was found, or -1 if even the network without interdependencies is infeasible (or its costs are too large for the network simplex).  If a later subproblem's costs grow too large, or its simplex gives up, the method stops with the best bound so far.
+*/
+int solve_lagrangian(const Instance&, Result&, Result&, vector<LagrangianStep>&, int = LAGRANGE_ITERATIONS);
@@ -0,0 +1,65 @@
+/*
+Reads and writes LP basis files.  The file is plain text:
+	b DENSITY NODES
+followed by one "x FLOW STATUS" line per arc and one "r STATUS" line per node, in ID order.
+*/
+
+#include <fstream>
+#include <string>
+#include "LpBasis.h"
+#include "Timer.h"
+using namespace std;
+
+// Writes the flows and basis of an LP result.  Returns 0 if successful.
+int write_basis(string file_name, const Instance & inst, const Result & res)
+{
+	if ((long)res.flow.size() != inst.DENSITY || (long)res.arc_status.size() != inst.DENSITY || (long)res.node_status.size() != inst.NODES)
+		return -1;
+
+	PhaseTimer timer(PHASE_WRITE);
+	ofstream outfile;
+	outfile.open(file_name);
+	if (outfile.is_open() == false)
+		return -1;
+	outfile.precision(17); // enough to read back exactly
+	outfile << "b " << inst.DENSITY << ' ' << inst.NODES << '\n';
+	for (long i = 0; i < inst.DENSITY; i++)
+		outfile << "x " << res.flow[i] << ' ' << res.arc_status[i] << '\n';
+	for (long i = 0; i < inst.NODES; i++)
+		outfile << "r " << res.node_status[i] << '\n';
+	bool ok = outfile.good();
+	outfile.close();
+	if (ok == false)
+		return -1;
+	return 0;
+}
+
+// Reads a basis file for the instance.  Returns 0 if successful.
+int read_basis(string file_name, const Instance & inst, Result & res)
+{
+	PhaseTimer timer(PHASE_PARSE);
+	ifstream infile;
+	infile.open(file_name);
+	if (infile.is_open() == false)
+		return -1;
+
+	string tag;
+	long arcs, nodes;
+	if (!(infile >> tag >> arcs >> nodes) || tag != "b" || arcs != inst.DENSITY || nodes != inst.NODES)
+		return -1;
+	res.flow.resize(arcs);
+	res.arc_status.resize(arcs);
+	res.node_status.resize(nodes);
+	for (long i = 0; i < arcs; i++)
+	{
+		if (!(infile >> tag >> res.flow[i] >> res.arc_status[i]) || tag != "x")
+			return -1;
+	}
+	for (long i = 0; i < nodes; i++)
+	{
+		if (!(infile >> tag >> res.node_status[i]) || tag != "r")
+			return -1;
+	}
+	infile.close();
+	return 0;
+}
@@ -0,0 +1,15 @@
+#pragma once
+#include <string>
+#include "Instance.h"
+using namespace std;
+
+/*
+The LP relaxation's optimal flows and basis, saved so that later solves of the same network (the RR attempts) can start from them instead of from scratch.  Statuses are numbered as in IloCplex::BasisStatus.  Only the arc variables and the node balance rows are kept, since the interdependency rows don't appear in the rounded models.
+*/
+#define BASIS_NONE 0
+#define BASIS_BASIC 1
+#define BASIS_LOWER 2
+#define BASIS_UPPER 3
+
+int write_basis(string, const Instance&, const Result&); // write LP flows and basis to specified file; output 0 if it worked, or -1 if not
+int read_basis(string, const Instance&, Result&); // read LP flows and basis from specified file; output 0 if it worked, or -1 if not
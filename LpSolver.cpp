@@ -1,76 +1,89 @@
 /*
-Reads in a specified .min file generated by NETGEN, interpreted as an LP. Feeds the problem to CPLEX and writes the results to three specified files: one for cost/time, one for parent flows, and one for child flows (for use in RR schemes). We expect exactly four arguments: the name of the .min file, the name of the main output file, the name of the parent flow file, and the name of the child flow file.
+Reads in a specified .min file generated by NETGEN, interpreted as an LP. Feeds the problem to CPLEX and writes the results to three specified files: one for cost/time, one for parent flows, and one for child flows (for use in RR schemes). We expect exactly four arguments: the name of the .min file, the name of the main output file, the name of the parent flow file, and the name of the child flow file. A fifth argument is optional: the name of a file for the optimal arc flows and basis (see LpBasis.h), which the RR solver can warm-start from.  The last argument may also choose the solver: "-native" solves with the side-constrained simplex (see SideSimplex.h) instead of CPLEX, and "-check" solves with both, checks that they agree on whether there is a solution, that their objectives agree, and that the native solution satisfies every constraint, and reports how many parent/child fractions differ (which they can where the optimum isn't unique), writing CPLEX's results.
+
+The input may also be a binary instance file (see BinFile.h), which is recognized by its first few bytes.
+
+When compiled with MCNFLI_LIB defined, the main method is left out and the solver is instead called in-process through solve_lp() (see LpSolver.h).
 */
 
 #include <iostream>
 #include <string>
 #include <fstream>
+#include <cmath>
 #include "ilcplex\cplex.h"
 #include "ilcplex\ilocplex.h"
+#include "BinFile.h"
+#include "LpBasis.h"
+#include "LpSolver.h"
+#include "ModelBuilder.h"
+#include "SideSimplex.h"
+#include "Timer.h"
 using namespace std;
 
-// Global variables and structures
-string input_name;
-string output_name;
-string parent_out_name;
-string child_out_name;
-long NODES;
-long SOURCES;
-long SINKS;
-long DENSITY;
-long DENSITY_INIT; // initial density, before artificial arcs are added
-int PARENT;
-long INTER;
-#define MAXNODES 5000
-#define MAXARCS 60000
-long b[MAXNODES];
-long u[MAXARCS];
-long c[MAXARCS];
-unsigned long tail[MAXARCS];
-long head[MAXARCS]; // negative head means we're ignoring it
-unsigned long parent[MAXARCS];
-unsigned long child[MAXARCS];
-double parent_flow[MAXARCS];
-double child_flow[MAXARCS];
-const double delivery_cost = -100; // unit delivery "reward" for relaxed sinks
-double sol_objective;
-double sol_time;
-double sol_load;
-
-// Prototypes
-int readin();
-int to_cplex();
-
+#ifndef MCNFLI_LIB
 int main(int argc, char* argv[])
 {
-	if (argc != 5)
+	string option = "";
+	if (argc >= 6 && argv[argc - 1][0] == '-')
+		option = argv[--argc];
+	if ((argc != 5 && argc != 6) || (option != "" && option != "-native" && option != "-check"))
 	{
-		cout << "Expecting the following 4 arguments: [input file] [output file] [parent flow file] [child flow file]\n";
+		cout << "Expecting the following 4 (5) arguments: [input file] [output file] [parent flow file] [child flow file] ([basis file]), optionally followed by -native or -check\n";
 		return -1;
 	}
 	else
 	{
-		// Save parameters as global variables
-		input_name = argv[1];
-		output_name = argv[2];
-		parent_out_name = argv[3];
-		child_out_name = argv[4];
+		// Save parameters
+		string input_name = argv[1];
+		string output_name = argv[2];
+		string parent_out_name = argv[3];
+		string child_out_name = argv[4];
+		Instance inst;
+		Result res;
 
 		// Try to read in the problem
-		if (readin() == 0)
+		if (read_instance(input_name, inst) == 0)
 		{
+			// Solve natively first if we're comparing solvers
+			Result native;
+			int native_output = 0;
+			if (option == "-check")
+			{
+				native_output = solve_lp_native(inst, native);
+				cout << "Native simplex: objective " << native.objective << ", time " << native.time;
+				if (native_output == 0)
+					cout << ", largest violation " << lp_violation(inst, native);
+				cout << '\n';
+			}
+
 			// Try to solve the problem
-			if (to_cplex() == 0)
+			int output = (option == "-native" ? solve_lp_native(inst, res) : solve_lp(inst, res));
+			if (option == "-check")
+			{
+				cout << "CPLEX: objective " << res.objective << ", time " << res.time << '\n';
+				if (output != native_output || (output == 0 && (fabs(res.objective - native.objective) > 1e-6 * (1 + fabs(res.objective)) || lp_violation(inst, native) > 1e-6)))
+				{
+					cout << "Solvers disagree.\n";
+					return -1;
+				}
+				int differ = 0;
+				for (int i = 0; output == 0 && i < inst.INTER; i++)
+					if (fabs(res.parent_flow[i] - native.parent_flow[i]) > 1e-6 || fabs(res.child_flow[i] - native.child_flow[i]) > 1e-6)
+						differ++;
+				cout << "Solvers agree; " << differ << " of " << inst.INTER << " interdependencies have different fractions.\n";
+			}
+			if (output == 0)
 			{
 				// If the solution is found, output the results to a file
 
 				// Main results
+				PhaseTimer timer(PHASE_WRITE);
 				ofstream outfile;
 				outfile.open(output_name);
 				if (outfile.is_open())
 				{
 					outfile << fixed;
-					outfile << sol_objective << '\n' << sol_time << '\n' << sol_load;
+					outfile << res.objective << '\n' << res.time << '\n' << res.load;
 					outfile.close();
 
 
@@ -80,20 +93,30 @@ int main(int argc, char* argv[])
 					if (parentfile.is_open())
 					{
 						parentfile << fixed;
-						for (int i = 0; i < INTER; i++)
-							parentfile << (1.0 * parent_flow[i]) / u[parent[i]] << '\n';
+						for (int i = 0; i < inst.INTER; i++)
+							parentfile << res.parent_flow[i] << '\n';
 						parentfile.close();
-						
+
 						// Child flows
 						ofstream childfile;
 						childfile.open(child_out_name);
 						if (childfile.is_open())
 						{
 							childfile << fixed;
-							for (int i = 0; i < INTER; i++)
-								childfile << (1.0 * child_flow[i]) / u[child[i]] << '\n';
+							for (int i = 0; i < inst.INTER; i++)
+								childfile << res.child_flow[i] << '\n';
 							childfile.close();
 
+							// Optimal flows and basis
+							timer.stop();
+							if (argc == 6 && write_basis(argv[5], inst, res) != 0)
+							{
+								cout << "Basis output file " << argv[5] << " failed to open.\n";
+								return -1;
+							}
+
+							if (timing_enabled)
+								thread_phase_times().print(cout);
 							return 0;
 						}
 						else
@@ -128,179 +151,84 @@ int main(int argc, char* argv[])
 		}
 	}
 }
+#endif
 
-// Reads specified input file.  Returns 0 if successful.
-int readin()
-{
-	int phase = 0; // 0 for objective, 1 for sources, 2 for sinks, 3 for arcs, 4 for interdependencies
-	ifstream infile;
-	infile.open(input_name);
-	if (infile.is_open())
-	{
-		// Read in the .min file line-by-line, filling the vectors as we go
-		int counter = 0; // counter for node or arc number
-		while (infile.eof() == false)
-		{
-			string line, piece; // current line and piece of line
-			getline(infile, line); // get whole line
-			stringstream stream(line); // stream of line
-			int id; // numbers read from line
-
-			// Categorize type of line based on the first character
-			switch (line[0])
-			{
-			// Ignore comments (c)
-			case 'p': // min NODES DENSITY INTER PARENT
-				getline(stream, piece, ' '); // 'p'
-				getline(stream, piece, ' '); // "min"
-				getline(stream, piece, ' '); // NODES
-				NODES = stoi(piece);
-				getline(stream, piece, ' '); // DENSITY
-				DENSITY_INIT = stoi(piece);
-				DENSITY = DENSITY_INIT;
-				getline(stream, piece, ' '); // INTER
-				INTER = stoi(piece);
-				getline(stream, piece, ' '); // PARENTS
-				if (piece[0] == 'a')
-					PARENT = 1;
-				else
-					PARENT = 0;
-				phase = 1;
-				break;
-			case 'n': // n ID FLOW
-				getline(stream, piece, ' '); // 'n'
-				getline(stream, piece, ' '); // ID
-				id = stoi(piece);
-				getline(stream, piece, ' '); // FLOW
-				b[id - 1] = stoi(piece);
-				if (b[id - 1] < 0 && phase == 1)
-				{
-					// we've just hit the first sink
-					phase = 2;
-					SOURCES = counter;
-					counter = 0;
-				}
-				counter++;
-				break;
-			case 'a': // a SRC DST LOW CAP COST
-				if (phase == 1)
-				{
-					// there were no sinks
-					phase = 2;
-					SOURCES = counter;
-					counter = 0;
-				}
-				if (phase == 2)
-				{
-					// we've just hit the first arc
-					phase = 3;
-					SINKS = counter;
-					counter = 0;
-				}
-				getline(stream, piece, ' '); // 'a'
-				getline(stream, piece, ' '); // SRC
-				tail[counter] = stoi(piece) - 1;
-				getline(stream, piece, ' '); // DST
-				head[counter] = stoi(piece) - 1;
-				getline(stream, piece, ' '); // LOW
-				getline(stream, piece, ' '); // CAP
-				u[counter] = stoi(piece);
-				getline(stream, piece, ' '); // COST
-				c[counter] = stoi(piece);
-				counter++;
-				break;
-			case 'i': // i parent child
-				if (phase == 3)
-				{
-					// we've just hit the first interdependency
-					phase = 4;
-					counter = 0;
-				}
-				getline(stream, piece, ' '); // 'i'
-				getline(stream, piece, ' '); // parent
-				parent[counter] = stoi(piece) - 1;
-				getline(stream, piece, ' '); // child
-				child[counter] = stoi(piece) - 1;
-				counter++;
-				break;
-			}
-		}
-
-		infile.close();
-		return 0;
-	}
-	else
-		return -1;
-}
-
-// Builds and exports the model defined by the input file.  Outputs 0 if a solution is found.
-int to_cplex()
+// Builds and exports the model defined by the instance, using its incidence matrix if one is given.  Outputs 0 if a solution is found, SOLVE_INFEASIBLE if CPLEX proves that there is none, or -1 if it stops without either.
+int solve_lp(const Instance & inst, Result & res, int threads, const NetworkMatrix * matrix)
 {
 	// Prepare CPLEX
+	PhaseTimer timer(PHASE_LP_BUILD);
 	IloEnv env; // environment
 	IloModel model(env); // model
 
-	// Variables and bounds
-	IloNumVarArray x(env);
-	for (int i = 0; i < DENSITY; i++)
-		x.add(IloNumVar(env, 0, u[i], ILOFLOAT));
-
-	// Network constraints
-	IloRangeArray con1(env);
-	for (int i = 0; i < NODES; i++)
-	{
-		if (PARENT == 0 && i < SOURCES)
-			con1.add(IloRange(env, 0, b[i])); // relax source supply values if we're using nodes as parents
-		else
-			con1.add(IloRange(env, b[i], b[i])); // otherwise, it's an equality constraint
-	}
-	for (int i = 0; i < DENSITY; i++)
-	{
-		con1[tail[i]].setLinearCoef(x[i], 1); // tail coefficient
-		if (head[i] >= 0)
-			con1[head[i]].setLinearCoef(x[i], -1); // head coefficient (only applies to non-auxiliary arcs)
-	}
-	model.add(con1);
+	// Network: flow columns, balance rows and objective (from the given incidence matrix, or one built just for this)
+	NetworkMatrix * built = (matrix == nullptr ? new NetworkMatrix(inst) : nullptr);
+	IloNumVarArray x;
+	IloRangeArray con1;
+	IloObjective obj;
+	build_network(env, model, inst, matrix != nullptr ? *matrix : *built, x, con1, obj);
+	delete built;
 
 	// Interdependencies
 	IloRangeArray con2(env);
-	for (int i = 0; i < INTER; i++)
-		con2.add(0 <= (1.0 / u[parent[i]]) * x[parent[i]] - (1.0 / u[child[i]]) * x[child[i]]); // fraction of child usage cannot exceed fraction of parent usage
+	for (int i = 0; i < inst.INTER; i++)
+		con2.add(0 <= (1.0 / inst.u[inst.parent[i]]) * x[inst.parent[i]] - (1.0 / inst.u[inst.child[i]]) * x[inst.child[i]]); // fraction of child usage cannot exceed fraction of parent usage
 	model.add(con2);
 
-	// Objective
-	IloObjective obj = IloMinimize(env);
-	for (int i = 0; i < DENSITY; i++)
-		obj.setLinearCoef(x[i], c[i]); // arc cost coefficient
-	model.add(obj);
-
 	// Extraction and solution
+	timer.next(PHASE_LP_EXTRACT);
 	IloCplex cplex(env); // Cplex object
+	if (threads > 0)
+		cplex.setParam(IloCplex::Param::Threads, threads); // leave cores for any other trials running alongside this one
 	cplex.extract(model);
+	timer.next(PHASE_LP_SOLVE);
 	IloNum start = cplex.getTime(); // starting time
 	IloBool solved = cplex.solve();
-	sol_time = cplex.getTime() - start; // stop timer
+	res.time = cplex.getTime() - start; // stop timer
+	IloAlgorithm::Status status = cplex.getStatus();
+	timer.next(PHASE_LP_RESULTS);
 
 	// Result output
+	res.parent_flow.assign(inst.INTER, 0);
+	res.child_flow.assign(inst.INTER, 0);
 	if (solved == IloTrue)
 	{
-		sol_objective = cplex.getObjValue();
-		for (int i = 0; i < INTER; i++)
+		res.objective = cplex.getObjValue();
+		for (int i = 0; i < inst.INTER; i++)
 		{
-			// record parent/child flow values
-			parent_flow[i] = cplex.getValue(x[parent[i]]);
-			child_flow[i] = cplex.getValue(x[child[i]]);
+			// record parent/child flow values as fractions of capacity
+			res.parent_flow[i] = (1.0 * cplex.getValue(x[inst.parent[i]])) / inst.u[inst.parent[i]];
+			res.child_flow[i] = (1.0 * cplex.getValue(x[inst.child[i]])) / inst.u[inst.child[i]];
 		}
 		// calculate average fullness of all arc flows
-		sol_load = 0;
-		for (int i = 0; i < DENSITY; i++)
-			sol_load += cplex.getValue(x[i]) / u[i];
-		sol_load /= DENSITY;
+		IloNumArray values(env);
+		cplex.getValues(values, x);
+		res.flow.resize(inst.DENSITY);
+		res.load = 0;
+		for (int i = 0; i < inst.DENSITY; i++)
+		{
+			res.flow[i] = values[i];
+			res.load += values[i] / inst.u[i];
+		}
+		res.load /= inst.DENSITY;
+		values.end();
+
+		// keep the optimal basis of the network part, for warm-starting the RR solves
+		IloCplex::BasisStatusArray arc_status(env), node_status(env);
+		cplex.getBasisStatuses(arc_status, x, node_status, con1);
+		res.arc_status.resize(inst.DENSITY);
+		res.node_status.resize(inst.NODES);
+		for (int i = 0; i < inst.DENSITY; i++)
+			res.arc_status[i] = arc_status[i];
+		for (int i = 0; i < inst.NODES; i++)
+			res.node_status[i] = node_status[i];
+		arc_status.end();
+		node_status.end();
 	}
 	else
 	{
-		sol_objective = -999;
-		sol_time = -999;
+		res.objective = -999;
+		res.time = -999;
 	}
 
 	// Finalization
@@ -308,6 +236,8 @@ int to_cplex()
 	env.end();
 	if (solved == IloTrue)
 		return 0;
+	else if (status == IloAlgorithm::Infeasible || status == IloAlgorithm::InfeasibleOrUnbounded) // every variable is bounded, so it can't be unbounded
+		return SOLVE_INFEASIBLE;
 	else
 		return -1;
-}
\ No newline at end of file
+}
@@ -0,0 +1,11 @@
+#pragma once
+#include "Instance.h"
+
+struct NetworkMatrix; // see ModelBuilder.h
+
+// LP engines for the Driver
+#define LP_CPLEX 0
+#define LP_NATIVE 1 // side-constrained simplex (see SideSimplex.h)
+
+// Solves the LP relaxation of an instance with CPLEX.  An optional thread limit is passed on to CPLEX (0 lets CPLEX decide).  Returns 0 if a solution is found, filling the objective, time, load, parent/child flow fractions, and arc flows and basis of the result, SOLVE_INFEASIBLE (see Instance.h) if CPLEX proves that there is none, or -1 if it fails in some other way.  The instance's incidence matrix may be passed in if it has already been built (otherwise it's built here).
+int solve_lp(const Instance&, Result&, int = 0, const NetworkMatrix* = nullptr);
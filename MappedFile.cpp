@@ -0,0 +1,110 @@
+/*
+Memory-mapped file access for the instance readers.  Windows uses CreateFileMapping/MapViewOfFile and everything else uses POSIX mmap.  An empty file is treated as a successful open of zero bytes, since neither API will map one.
+*/
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include "MappedFile.h"
+using namespace std;
+
+MappedFile::MappedFile()
+{
+	data = nullptr;
+	length = 0;
+#ifdef _WIN32
+	file_handle = INVALID_HANDLE_VALUE;
+	map_handle = NULL;
+#else
+	file_descriptor = -1;
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+	close();
+}
+
+/*** Map a file into memory.  Any previous mapping is released first. */
+int MappedFile::open(string file_name)
+{
+	close();
+#ifdef _WIN32
+	file_handle = CreateFileA(file_name.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (file_handle == INVALID_HANDLE_VALUE)
+		return -1;
+	LARGE_INTEGER file_size;
+	if (GetFileSizeEx(file_handle, &file_size) == 0)
+	{
+		close();
+		return -1;
+	}
+	length = (size_t)file_size.QuadPart;
+	if (length == 0)
+		return 0;
+	map_handle = CreateFileMappingA(file_handle, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (map_handle == NULL)
+	{
+		close();
+		return -1;
+	}
+	data = (const char*)MapViewOfFile(map_handle, FILE_MAP_READ, 0, 0, 0);
+	if (data == nullptr)
+	{
+		close();
+		return -1;
+	}
+#else
+	file_descriptor = ::open(file_name.c_str(), O_RDONLY);
+	if (file_descriptor < 0)
+		return -1;
+	struct stat file_status;
+	if (fstat(file_descriptor, &file_status) != 0)
+	{
+		close();
+		return -1;
+	}
+	length = (size_t)file_status.st_size;
+	if (length == 0)
+		return 0;
+	void* view = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+	if (view == MAP_FAILED)
+	{
+		close();
+		return -1;
+	}
+	madvise(view, length, MADV_SEQUENTIAL); // we only ever read front to back
+	data = (const char*)view;
+#endif
+	return 0;
+}
+
+/*** Release the mapping and the file. */
+void MappedFile::close()
+{
+#ifdef _WIN32
+	if (data != nullptr)
+		UnmapViewOfFile(data);
+	if (map_handle != NULL)
+		CloseHandle(map_handle);
+	if (file_handle != INVALID_HANDLE_VALUE)
+		CloseHandle(file_handle);
+	file_handle = INVALID_HANDLE_VALUE;
+	map_handle = NULL;
+#else
+	if (data != nullptr)
+		munmap((void*)data, length);
+	if (file_descriptor >= 0)
+		::close(file_descriptor);
+	file_descriptor = -1;
+#endif
+	data = nullptr;
+	length = 0;
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include <string>
+#include <cstddef>
+using namespace std;
+
+/*
+A read-only view of a whole file, memory-mapped so that the contents can be scanned in place without copying them through a stream buffer.  The mapping is released when the object is destroyed.
+*/
+class MappedFile
+{
+private:
+	const char* data; // start of the file contents
+	size_t length; // number of bytes in the file
+#ifdef _WIN32
+	void* file_handle;
+	void* map_handle;
+#else
+	int file_descriptor;
+#endif
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+public:
+	MappedFile();
+	~MappedFile();
+	int open(string); // map the specified file; output 0 if it worked, or -1 if not
+	void close(); // release the mapping
+	const char* begin() const { return data; }
+	const char* end() const { return data + length; }
+	size_t size() const { return length; }
+};
@@ -0,0 +1,217 @@
+/*
+Dinic's maximum flow for the feasibility oracle (see MaxFlow.h).
+
+Each phase labels the nodes by their breadth-first distance from the super source in the residual network, then sends a blocking flow along shortest paths only.  Paths are followed with an explicit stack and a current-edge pointer per node, so a phase never looks at an edge twice, and nodes that lead nowhere are dropped from the level graph.
+*/
+
+#include <climits>
+#include <algorithm>
+#include "MaxFlow.h"
+using namespace std;
+
+// Sets up the residual network for an instance, with every arc's bounds at [0,u].
+FeasibilityOracle::FeasibilityOracle(const Instance & instance) : inst(instance)
+{
+	node_count = inst.NODES + 1;
+	long ground = inst.NODES;
+	super_source = node_count;
+	super_sink = node_count + 1;
+
+	// Instance arcs, with auxiliary arcs ending at the ground node
+	for (long i = 0; i < inst.DENSITY; i++)
+		add_edge(inst.tail[i], inst.head[i] >= 0 ? inst.head[i] : ground);
+	lower.assign(inst.DENSITY, 0);
+	upper.assign(inst.u.begin(), inst.u.end());
+
+	// Supplies, with the ground node taking up the imbalance
+	base_supply.assign(node_count, 0);
+	long long total = 0;
+	for (long i = 0; i < inst.NODES; i++)
+	{
+		base_supply[i] = inst.b[i];
+		total += inst.b[i];
+	}
+	base_supply[ground] = -total;
+
+	// Dump arcs for relaxed sources
+	for (long i = 0; i < inst.NODES; i++)
+		if (inst.PARENT == 0 && i < inst.SOURCES && inst.b[i] > 0)
+			add_edge(i, ground);
+	arc_count = to.size() / 2;
+
+	// An arc from the super source and one to the super sink for every node
+	for (long v = 0; v < node_count; v++)
+	{
+		add_edge(super_source, v);
+		add_edge(v, super_sink);
+	}
+	cap.assign(to.size(), 0);
+
+	// Group the residual edges by the node they leave
+	long total_nodes = node_count + 2;
+	first.assign(total_nodes + 1, 0);
+	for (long e = 0; e < (long)to.size(); e++)
+		first[to[e ^ 1] + 1]++;
+	for (long v = 0; v < total_nodes; v++)
+		first[v + 1] += first[v];
+	adj.resize(to.size());
+	vector<long> slot(first.begin(), first.end() - 1); // next free place in each node's range
+	for (long e = 0; e < (long)to.size(); e++)
+		adj[slot[to[e ^ 1]]++] = e;
+
+	level.resize(total_nodes);
+	current.resize(total_nodes);
+	queue.resize(total_nodes);
+	shortfall = 0;
+}
+
+// Adds an arc and its reverse to the residual network.
+void FeasibilityOracle::add_edge(long from, long target)
+{
+	to.push_back(target);
+	to.push_back(from);
+}
+
+// Changes an instance arc's bounds for the next check.
+void FeasibilityOracle::set_bounds(long arc, long lb, long ub)
+{
+	lower[arc] = lb;
+	upper[arc] = ub;
+}
+
+// Checks whether the current bounds admit a feasible flow.  If not, the shortfall is the supply that couldn't be sent.
+bool FeasibilityOracle::feasible()
+{
+	shortfall = 0;
+
+	// Shift lower bounds into the supplies
+	vector<long long> supply(base_supply);
+	for (long a = 0; a < inst.DENSITY; a++)
+	{
+		if (upper[a] < lower[a])
+		{
+			shortfall = lower[a] - upper[a];
+			return false;
+		}
+		cap[2 * a] = upper[a] - lower[a];
+		cap[2 * a + 1] = 0;
+		supply[to[2 * a + 1]] -= lower[a];
+		supply[to[2 * a]] += lower[a];
+	}
+	for (long a = inst.DENSITY; a < arc_count; a++)
+	{
+		cap[2 * a] = base_supply[to[2 * a + 1]];
+		cap[2 * a + 1] = 0;
+	}
+
+	// Super source and sink arcs carry the supplies
+	long long needed = 0;
+	for (long v = 0; v < node_count; v++)
+	{
+		long e = 2 * (arc_count + 2 * v);
+		cap[e] = supply[v] > 0 ? supply[v] : 0;
+		cap[e + 1] = 0;
+		cap[e + 2] = supply[v] < 0 ? -supply[v] : 0;
+		cap[e + 3] = 0;
+		needed += cap[e];
+	}
+
+	long long sent = 0;
+	while (sent < needed && build_levels())
+		sent += augment();
+	shortfall = needed - sent;
+	return shortfall == 0;
+}
+
+// Labels nodes by their distance from the super source in the residual network.  Returns true if the super sink can be reached.
+bool FeasibilityOracle::build_levels()
+{
+	long total_nodes = node_count + 2;
+	for (long v = 0; v < total_nodes; v++)
+	{
+		level[v] = -1;
+		current[v] = first[v];
+	}
+	long q_head = 0, q_tail = 0;
+	level[super_source] = 0;
+	queue[q_tail++] = super_source;
+	while (q_head < q_tail)
+	{
+		long v = queue[q_head++];
+		for (long i = first[v]; i < first[v + 1]; i++)
+		{
+			long e = adj[i];
+			if (cap[e] > 0 && level[to[e]] < 0)
+			{
+				level[to[e]] = level[v] + 1;
+				queue[q_tail++] = to[e];
+			}
+		}
+	}
+	return level[super_sink] >= 0;
+}
+
+/*
+Sends a blocking flow through the level graph.  The path from the super source is kept on a stack: it advances along the current edge of its last node, retreats past nodes with no way forward, and after each augmentation falls back to just before its first saturated edge.  Returns the amount sent.
+*/
+long long FeasibilityOracle::augment()
+{
+	long long total = 0;
+	long v = super_source;
+	path.clear();
+	while (true)
+	{
+		if (v == super_sink)
+		{
+			long long push = LLONG_MAX;
+			for (long e : path)
+				push = min(push, cap[e]);
+			size_t back = path.size();
+			for (size_t i = 0; i < path.size(); i++)
+			{
+				cap[path[i]] -= push;
+				cap[path[i] ^ 1] += push;
+				if (cap[path[i]] == 0 && back == path.size())
+					back = i;
+			}
+			total += push;
+			path.resize(back);
+			v = path.empty() ? super_source : to[path.back()];
+			continue;
+		}
+
+		// Advance along an edge to the next level, if there is one
+		long end = first[v + 1];
+		while (current[v] < end)
+		{
+			long e = adj[current[v]];
+			if (cap[e] > 0 && level[to[e]] == level[v] + 1)
+				break;
+			current[v]++;
+		}
+		if (current[v] < end)
+		{
+			path.push_back(adj[current[v]]);
+			v = to[path.back()];
+			continue;
+		}
+
+		// Dead end, so retreat
+		if (v == super_source)
+			break;
+		level[v] = -1;
+		path.pop_back();
+		v = path.empty() ? super_source : to[path.back()];
+		current[v]++;
+	}
+	return total;
+}
+
+// Checks whether an instance's network has any feasible flow, with every arc's bounds at [0,u].
+bool network_feasible(const Instance & inst)
+{
+	FeasibilityOracle * oracle = new FeasibilityOracle(inst);
+	bool output = oracle->feasible();
+	delete oracle;
+	return output;
+}
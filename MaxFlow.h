@@ -0,0 +1,39 @@
+#pragma once
+#include <vector>
+#include "Instance.h"
+using namespace std;
+
+/*
+Feasibility oracle for an instance's network: decides whether the node balance constraints can be met with every arc's flow between its lower and upper bound, ignoring costs.  This is far cheaper than an optimal solve, so roundings (and whole instances) that can't have any solution are rejected before they reach a solver.
+
+The network is transformed just as for the network simplex (see MinCostFlow.h): a ground node (numbered NODES) takes the imbalance, auxiliary arcs end there, relaxed sources get dump arcs, and lower bounds are shifted into the node supplies.  A super source then feeds every node with positive supply and a super sink drains every node with negative supply, and the network is feasible exactly when Dinic's maximum flow saturates the super source.
+*/
+class FeasibilityOracle
+{
+private:
+	const Instance & inst;
+	long node_count; // real nodes plus the ground node
+	long arc_count; // instance arcs plus dump arcs
+	long super_source, super_sink;
+	vector<long> lower, upper; // current bounds of the instance arcs
+	vector<long long> base_supply; // supply of each node before shifting out lower bounds
+	// residual network: edge 2a is arc a forwards and edge 2a+1 is its reverse, with arcs to and from the super nodes after the real arcs
+	vector<long> to;
+	vector<long long> cap;
+	vector<long> first, adj; // each node's residual edges, as a range of adj
+	// Dinic scratch space
+	vector<long> level, current, queue, path;
+	long long shortfall; // supply that couldn't be sent in the last check
+	// methods
+	void add_edge(long, long);
+	bool build_levels();
+	long long augment();
+public:
+	FeasibilityOracle(const Instance&);
+	void set_bounds(long, long, long); // set an arc's lower and upper flow bounds
+	bool feasible(); // check the current bounds
+	long long get_shortfall() const { return shortfall; } // supply that couldn't be sent in the last check (0 if feasible)
+};
+
+// Checks whether an instance's network, with every arc's flow in [0,u], has any feasible flow at all.  If not, neither the MILP nor the LP can be solved.
+bool network_feasible(const Instance&);
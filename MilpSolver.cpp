@@ -1,71 +1,80 @@
 /*
-Reads in a specified .min file generated by NETGEN, interpreted as a MILP. Feeds the problem to CPLEX and writes the results to a specified file. We expect exactly two arguments: the name of the .min file, and the name of the output file.
+Reads in a specified .min file generated by NETGEN, interpreted as a MILP. Feeds the problem to CPLEX and writes the results to a specified file. We expect two arguments: the name of the .min file, and the name of the output file.  An optional third argument chooses the formulation (see MilpSolver.h): "-compact" solves the compact one instead of the standard one, and "-check" solves both and checks that their optimal objectives agree, writing the compact one's results.
+
+The input may also be a binary instance file (see BinFile.h), which is recognized by its first few bytes.
+
+When compiled with MCNFLI_LIB defined, the main method is left out and the solver is instead called in-process through solve_milp() (see MilpSolver.h).
 */
 
 #include <iostream>
 #include <string>
 #include <fstream>
+#include <cmath>
 #include "ilcplex\cplex.h"
 #include "ilcplex\ilocplex.h"
+#include "BinFile.h"
+#include "MilpSolver.h"
+#include "ModelBuilder.h"
+#include "Timer.h"
 using namespace std;
 
-// Global variables and structures
-string input_name;
-string output_name;
-long NODES;
-long SOURCES;
-long SINKS;
-long DENSITY;
-long DENSITY_INIT; // initial density, before artificial arcs are added
-int PARENT;
-long INTER;
-#define MAXNODES 5000
-#define MAXARCS 60000
-long b[MAXNODES];
-long u[MAXARCS];
-long c[MAXARCS];
-unsigned long tail[MAXARCS];
-long head[MAXARCS]; // negative head means we're ignoring it
-unsigned long parent[MAXARCS];
-unsigned long child[MAXARCS];
-double parent_flow[MAXARCS];
-double child_flow[MAXARCS];
-const double delivery_cost = -100; // unit delivery "reward" for relaxed sinks
-double sol_objective;
-double sol_time;
-double sol_load;
-
-// Prototypes
-int readin();
-int to_cplex();
+static bool add_starts(IloEnv, IloCplex&, IloNumVarArray, IloNumVarArray, IloNumVarArray, const Instance&, const vector<Result>&, bool);
 
+#ifndef MCNFLI_LIB
 int main(int argc, char* argv[])
 {
-	if (argc != 3)
+	string option = (argc == 4 ? argv[3] : "");
+	if ((argc != 3 && argc != 4) || (argc == 4 && option != "-compact" && option != "-check"))
 	{
-		cout << "Expecting the following 2 arguments: [input file] [output file]\n";
+		cout << "Expecting the following 2 (3) arguments: [input file] [output file] (-compact or -check)\n";
 		return -1;
 	}
 	else
 	{
-		// Save parameters as global variables
-		input_name = argv[1];
-		output_name = argv[2];
+		// Save parameters
+		string input_name = argv[1];
+		string output_name = argv[2];
+		Instance inst;
+		Result res;
 
 		// Try to read in the problem
-		if (readin() == 0)
+		if (read_instance(input_name, inst) == 0)
 		{
+			// Solve the standard formulation first if we're comparing them
+			Result standard;
+			int standard_output = 0;
+			if (option == "-check")
+			{
+				standard_output = solve_milp(inst, standard, 0, nullptr, MILP_STANDARD);
+				cout << "Standard formulation: objective " << standard.objective << ", time " << standard.time << '\n';
+			}
+
 			// Try to solve the problem
-			if (to_cplex() == 0)
+			int output = solve_milp(inst, res, 0, nullptr, option == "" ? MILP_STANDARD : MILP_COMPACT);
+			if (option == "-check")
+			{
+				cout << "Compact formulation: objective " << res.objective << ", time " << res.time << '\n';
+				if (output != standard_output || (output == 0 && fabs(res.objective - standard.objective) > 1e-6 * (1 + fabs(standard.objective))))
+				{
+					cout << "Formulations disagree.\n";
+					return -1;
+				}
+				cout << "Formulations agree.\n";
+			}
+			if (output == 0)
 			{
 				// If the solution is found, output the results to a file
+				PhaseTimer timer(PHASE_WRITE);
 				ofstream outfile;
 				outfile.open(output_name);
 				if (outfile.is_open())
 				{
 					outfile << fixed;
-					outfile << sol_objective << '\n' << sol_time << '\n' << sol_load;
+					outfile << res.objective << '\n' << res.time << '\n' << res.load;
 					outfile.close();
+					timer.stop();
+					if (timing_enabled)
+						thread_phase_times().print(cout);
 					return 0;
 				}
 				else
@@ -88,184 +97,83 @@ int main(int argc, char* argv[])
 		}
 	}
 }
+#endif
 
-// Reads specified input file.  Returns 0 if successful.
-int readin()
-{
-	int phase = 0; // 0 for objective, 1 for sources, 2 for sinks, 3 for arcs, 4 for interdependencies
-	ifstream infile;
-	infile.open(input_name);
-	if (infile.is_open())
-	{
-		// Read in the .min file line-by-line, filling the vectors as we go
-		int counter = 0; // counter for node or arc number
-		while (infile.eof() == false)
-		{
-			string line, piece; // current line and piece of line
-			getline(infile, line); // get whole line
-			stringstream stream(line); // stream of line
-			int id; // numbers read from line
-
-			// Categorize type of line based on the first character
-			switch (line[0])
-			{
-				// Ignore comments (c)
-				case 'p': // min NODES DENSITY INTER PARENT
-					getline(stream, piece, ' '); // 'p'
-					getline(stream, piece, ' '); // "min"
-					getline(stream, piece, ' '); // NODES
-					NODES = stoi(piece);
-					getline(stream, piece, ' '); // DENSITY
-					DENSITY_INIT = stoi(piece);
-					DENSITY = DENSITY_INIT;
-					getline(stream, piece, ' '); // INTER
-					INTER = stoi(piece);
-					getline(stream, piece, ' '); // PARENTS
-					if (piece[0] == 'a')
-						PARENT = 1;
-					else
-						PARENT = 0;
-					phase = 1;
-					break;
-				case 'n': // n ID FLOW
-					getline(stream, piece, ' '); // 'n'
-					getline(stream, piece, ' '); // ID
-					id = stoi(piece);
-					getline(stream, piece, ' '); // FLOW
-					b[id - 1] = stoi(piece);
-					if (b[id - 1] < 0 && phase == 1)
-					{
-						// we've just hit the first sink
-						phase = 2;
-						SOURCES = counter;
-						counter = 0;
-					}
-					counter++;
-					break;
-				case 'a': // a SRC DST LOW CAP COST
-					if (phase == 1)
-					{
-						// there were no sinks
-						phase = 2;
-						SOURCES = counter;
-						counter = 0;
-					}
-					if (phase == 2)
-					{
-						// we've just hit the first arc
-						phase = 3;
-						SINKS = counter;
-						counter = 0;
-					}
-					getline(stream, piece, ' '); // 'a'
-					getline(stream, piece, ' '); // SRC
-					tail[counter] = stoi(piece) - 1;
-					getline(stream, piece, ' '); // DST
-					head[counter] = stoi(piece) - 1;
-					getline(stream, piece, ' '); // LOW
-					getline(stream, piece, ' '); // CAP
-					u[counter] = stoi(piece);
-					getline(stream, piece, ' '); // COST
-					c[counter] = stoi(piece);
-					counter++;
-					break;
-				case 'i': // i parent child
-					if (phase == 3)
-					{
-						// we've just hit the first interdependency
-						phase = 4;
-						counter = 0;
-					}
-					getline(stream, piece, ' '); // 'i'
-					getline(stream, piece, ' '); // parent
-					parent[counter] = stoi(piece) - 1;
-					getline(stream, piece, ' '); // child
-					child[counter] = stoi(piece) - 1;
-					counter++;
-					break;
-			}
-		}
-
-		infile.close();
-		return 0;
-	}
-	else
-		return -1;
-}
-
-// Builds and exports the model defined by the input file.  Outputs 0 if a solution is found.
-int to_cplex()
+// Builds and exports the model defined by the instance in the chosen formulation, starting from any given solutions and using the instance's incidence matrix if one is given.  Outputs 0 if a solution is found, SOLVE_INFEASIBLE if CPLEX proves that there is none, -1 if it stops without either, or -2 if the model can't be extracted.
+int solve_milp(const Instance & inst, Result & res, int threads, const vector<Result> * starts, int formulation, const NetworkMatrix * matrix)
 {
 	try
 	{
 		// Prepare CPLEX
+		PhaseTimer timer(PHASE_MILP_BUILD);
 		IloEnv env; // environment
 		IloModel model(env); // model
 		
-		// Variables and bounds
-		IloNumVarArray x(env);
-		//for (int i = 0; i < tail.size(); i++)
-		for (int i = 0; i < DENSITY; i++)
-			x.add(IloNumVar(env, 0, u[i], ILOFLOAT));
+		// Network: flow columns, balance rows and objective (from the given incidence matrix, or one built just for this)
+		NetworkMatrix * built = (matrix == nullptr ? new NetworkMatrix(inst) : nullptr);
+		IloNumVarArray x;
+		IloRangeArray con1;
+		IloObjective obj;
+		build_network(env, model, inst, matrix != nullptr ? *matrix : *built, x, con1, obj);
+		delete built;
+
+		// Interdependency variables
 		IloNumVarArray s(env); // slack (note: this means slack at the parent, not the slack variables from our paper's formulation)
-		for (int i = 0; i < INTER; i++)
-			s.add(IloNumVar(env, 0, IloInfinity, ILOFLOAT));
+		if (formulation == MILP_STANDARD)
+			for (int i = 0; i < inst.INTER; i++)
+				s.add(IloNumVar(env, 0, IloInfinity, ILOFLOAT));
 		IloNumVarArray y(env); // binary
-		for (int i = 0; i < INTER; i++)
+		for (int i = 0; i < inst.INTER; i++)
 			y.add(IloNumVar(env, 0, 1, ILOBOOL));
 		
-		// Network constraints
-		IloRangeArray con1(env);
-		for (int i = 0; i < NODES; i++)
-		{
-			if (PARENT == 0 && i < SOURCES)
-				con1.add(IloRange(env, 0, b[i])); // relax source supply values if we're using nodes as parents
-			else
-				con1.add(IloRange(env, b[i], b[i])); // otherwise, it's an equality constraint
-		}
-		for (int i = 0; i < DENSITY; i++)
-		{
-			con1[tail[i]].setLinearCoef(x[i], 1); // tail coefficient
-			if (head[i] >= 0)
-				con1[head[i]].setLinearCoef(x[i], -1); // head coefficient (only applies to non-auxiliary arcs)
-		}
-		model.add(con1);
-		
 		// Interdependencies
 		IloRangeArray con2(env);
-		for (int i = 0; i < INTER; i++)
+		for (int i = 0; i < inst.INTER; i++)
 		{
-			con2.add(1.0 == ((1.0 * x[parent[i]]) / u[parent[i]]) + s[i]); // define s
-			con2.add(y[i] - s[i] >= 0); // s=0 leaves y free, s>0 forces y=1
-			con2.add(x[child[i]] + u[child[i]] * y[i] <= u[child[i]]); // shut off child if its y-variable is 1
+			if (formulation == MILP_STANDARD)
+			{
+				con2.add(1.0 == ((1.0 * x[inst.parent[i]]) / inst.u[inst.parent[i]]) + s[i]); // define s
+				con2.add(y[i] - s[i] >= 0); // s=0 leaves y free, s>0 forces y=1
+			}
+			else
+				con2.add(x[inst.parent[i]] + inst.u[inst.parent[i]] * y[i] >= inst.u[inst.parent[i]]); // a parent below capacity forces y=1 (y >= s with s substituted out)
+			con2.add(x[inst.child[i]] + inst.u[inst.child[i]] * y[i] <= inst.u[inst.child[i]]); // shut off child if its y-variable is 1
 		}
 		model.add(con2);
 		
-		// Objective
-		IloObjective obj = IloMinimize(env);
-		for (int i = 0; i < DENSITY; i++)
-			obj.setLinearCoef(x[i], c[i]); // arc cost coefficient
-		model.add(obj);
 		// Extraction and solution
+		timer.next(PHASE_MILP_EXTRACT);
 		IloCplex cplex(env); // Cplex object
+		if (threads > 0)
+			cplex.setParam(IloCplex::Param::Threads, threads); // leave cores for any other trials running alongside this one
 		cplex.extract(model);
+		bool cutoff = (starts != nullptr && add_starts(env, cplex, x, s, y, inst, *starts, formulation == MILP_STANDARD));
+		timer.next(PHASE_MILP_SOLVE);
 		IloNum start = cplex.getTime(); // starting time
 		IloBool solved = cplex.solve();
-		sol_time = cplex.getTime() - start; // stop timer
+		if (solved == IloFalse && cutoff)
+		{
+			// The starts are feasible, so this shouldn't happen, but don't let a rejected start make the instance look infeasible
+			cplex.setParam(IloCplex::Param::MIP::Tolerances::UpperCutoff, 1e75);
+			solved = cplex.solve();
+		}
+		res.time = cplex.getTime() - start; // stop timer
+		IloAlgorithm::Status status = cplex.getStatus();
+		timer.next(PHASE_MILP_RESULTS);
 		// Result output
 		if (solved == IloTrue)
 		{
-			sol_objective = cplex.getObjValue();
+			res.objective = cplex.getObjValue();
 			// calculate average fullness of all arc flows
-			sol_load = 0;
-			for (int i = 0; i < DENSITY; i++)
-				sol_load += cplex.getValue(x[i]) / u[i];
-			sol_load /= DENSITY;
+			res.load = 0;
+			for (int i = 0; i < inst.DENSITY; i++)
+				res.load += cplex.getValue(x[i]) / inst.u[i];
+			res.load /= inst.DENSITY;
 		}
 		else
 		{
-			sol_objective = -999;
-			sol_time = -999;
+			res.objective = -999;
+			res.time = -999;
 		}
 
 		// Finalization
@@ -273,6 +181,8 @@ int to_cplex()
 		env.end();
 		if (solved == IloTrue)
 			return 0;
+		else if (status == IloAlgorithm::Infeasible || status == IloAlgorithm::InfeasibleOrUnbounded) // every variable is bounded, so it can't be unbounded
+			return SOLVE_INFEASIBLE;
 		else
 			return -1;
 	}
@@ -284,4 +194,38 @@ int to_cplex()
 			cout << i + 1 << ": ID " << ea[i].getId() << '\n';
 		return -2;
 	}
-}
\ No newline at end of file
+}
+
+/*
+Loads each usable start as a MIP start.  A start's y and s values follow from its flows: s is the parent's unused fraction, and y is 0 if the parent is at capacity (leaving the child free) or 1 if not (the child is then shut off, as in every RR solution).  (The compact formulation has no s.)  CPLEX only checks the starts for feasibility, since they're complete.  Returns true if any start was loaded, after setting the upper cutoff to the best start's objective (plus a little, so that the best start itself isn't cut off).
+*/
+static bool add_starts(IloEnv env, IloCplex & cplex, IloNumVarArray x, IloNumVarArray s, IloNumVarArray y, const Instance & inst, const vector<Result> & starts, bool with_s)
+{
+	IloNumVarArray vars(env);
+	vars.add(x);
+	if (with_s)
+		vars.add(s);
+	vars.add(y);
+	double best = IloInfinity;
+	for (const Result & start : starts)
+	{
+		if (start.time < 0 || (long)start.flow.size() != inst.DENSITY)
+			continue;
+		IloNumArray values(env);
+		for (long i = 0; i < inst.DENSITY; i++)
+			values.add(start.flow[i]);
+		for (long i = 0; with_s && i < inst.INTER; i++)
+			values.add(1.0 - start.flow[inst.parent[i]] / inst.u[inst.parent[i]]);
+		for (long i = 0; i < inst.INTER; i++)
+			values.add(start.flow[inst.parent[i]] >= inst.u[inst.parent[i]] ? 0 : 1);
+		cplex.addMIPStart(vars, values, IloCplex::MIPStartCheckFeas);
+		values.end();
+		if (start.objective < best)
+			best = start.objective;
+	}
+	vars.end();
+	if (best == IloInfinity)
+		return false;
+	cplex.setParam(IloCplex::Param::MIP::Tolerances::UpperCutoff, best + 1e-6 * (1 + fabs(best)));
+	return true;
+}
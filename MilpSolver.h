@@ -0,0 +1,19 @@
+#pragma once
+#include <vector>
+#include "Instance.h"
+using namespace std;
+
+struct NetworkMatrix; // see ModelBuilder.h
+
+// MILP formulations of the interdependencies, which have the same optimal solutions
+#define MILP_STANDARD 0 // s[i] = 1 - x[parent]/u[parent], y[i] >= s[i], and x[child] + u[child]*y[i] <= u[child]
+#define MILP_COMPACT 1 // s substituted out: x[parent] + u[parent]*y[i] >= u[parent], and x[child] + u[child]*y[i] <= u[child]
+
+/*
+Solves the MILP version of an instance with CPLEX.  An optional thread limit is passed on to CPLEX (0 lets CPLEX decide).  Returns 0 if a solution is found, filling the objective, time, and load of the result, SOLVE_INFEASIBLE (see Instance.h) if CPLEX proves that there is none, or a negative value if it fails in some other way.
+
+Feasible solutions found beforehand (such as the RR results, which are feasible MILP solutions) may be passed in as the fourth argument.  Each result with a time of at least 0 and a flow for every arc becomes a MIP start, with its y and s values implied by the flows, and the best of their objectives becomes CPLEX's upper cutoff, so branch and bound only looks for better solutions.
+
+The fifth argument chooses the formulation.  The compact one has no s columns and two rows per interdependency instead of three.  The last is the instance's incidence matrix, if it has already been built (otherwise it's built here).
+*/
+int solve_milp(const Instance&, Result&, int = 0, const vector<Result>* = nullptr, int = MILP_STANDARD, const NetworkMatrix* = nullptr);
@@ -0,0 +1,59 @@
+/*
+Converts an instance between the .min text format and the binary instance format (see BinFile.h).  The input format is recognized from the file contents, and the output is written in the other format.  We expect exactly two arguments: the name of the input file and the name of the output file.
+*/
+
+#include <iostream>
+#include <string>
+#include "MinFile.h"
+#include "BinFile.h"
+#include "Timer.h"
+using namespace std;
+
+#ifndef MCNFLI_LIB
+int main(int argc, char* argv[])
+{
+	if (argc != 3)
+	{
+		cout << "Expecting the following 2 arguments: [input file] [output file]\n";
+		return -1;
+	}
+	else
+	{
+		string input_name = argv[1];
+		string output_name = argv[2];
+		Instance inst;
+
+		if (is_bin(input_name))
+		{
+			// Binary to text
+			if (read_bin(input_name, inst) != 0)
+			{
+				cout << "Failed to read binary instance file " << input_name << '\n';
+				return -1;
+			}
+			if (write_min(output_name, inst) != 0)
+			{
+				cout << "Output file " << output_name << " failed to open.\n";
+				return -1;
+			}
+		}
+		else
+		{
+			// Text to binary
+			if (read_min(input_name, inst) != 0)
+			{
+				cout << "Failed to read problem file " << input_name << '\n';
+				return -1;
+			}
+			if (write_bin(output_name, inst) != 0)
+			{
+				cout << "Output file " << output_name << " failed to open.\n";
+				return -1;
+			}
+		}
+		if (timing_enabled)
+			thread_phase_times().print(cout);
+		return 0;
+	}
+}
+#endif
@@ -0,0 +1,578 @@
+/*
+Native network simplex for rounded instances (see MinCostFlow.h).
+
+The layout follows the usual primal network simplex: arcs are stored as parallel arrays, the spanning tree as parent and predecessor-arc arrays with node depths (for finding the apex of a pivot cycle), and each node's children as a linked list, so that the subtree that moves in a pivot can be walked to update its depths and potentials.  Reduced costs are cost + pi[source] - pi[target], which is 0 on tree arcs.
+*/
+
+#include <cmath>
+#include <cstdlib>
+#include <climits>
+#include <chrono>
+#include "MinCostFlow.h"
+using namespace std;
+
+#define INF_CAP (LLONG_MAX / 4) // capacity of artificial arcs
+#define PIVOT_FACTOR 50 // a solve from scratch gives up after this many pivots per arc (far more than it should ever need)
+
+// Sets up the ground node and dump arcs for an instance, with every arc's bounds at [0,u].
+NetworkSimplex::NetworkSimplex(const Instance & instance) : inst(instance)
+{
+	node_count = inst.NODES + 1;
+	long ground = inst.NODES;
+
+	// Instance arcs, with auxiliary arcs ending at the ground node
+	for (long i = 0; i < inst.DENSITY; i++)
+	{
+		source.push_back(inst.tail[i]);
+		target.push_back(inst.head[i] >= 0 ? inst.head[i] : ground);
+		cost.push_back(inst.c[i]);
+	}
+	lower.assign(inst.DENSITY, 0);
+	upper.assign(inst.u.begin(), inst.u.end());
+
+	// Supplies, with the ground node taking up the imbalance
+	base_supply.assign(node_count, 0);
+	long long total = 0;
+	for (long i = 0; i < inst.NODES; i++)
+	{
+		base_supply[i] = inst.b[i];
+		total += inst.b[i];
+	}
+	base_supply[ground] = -total;
+
+	// Dump arcs for relaxed sources
+	for (long i = 0; i < inst.NODES; i++)
+	{
+		if (inst.PARENT == 0 && i < inst.SOURCES && inst.b[i] > 0)
+		{
+			source.push_back(i);
+			target.push_back(ground);
+			cost.push_back(0);
+		}
+	}
+	arc_count = source.size();
+
+	// Room for one artificial arc per node
+	source.resize(arc_count + node_count);
+	target.resize(arc_count + node_count);
+	cost.resize(arc_count + node_count);
+	cap.assign(arc_count + node_count, 0);
+	for (long a = inst.DENSITY; a < arc_count; a++)
+		cap[a] = base_supply[source[a]];
+	cut_excess = 0;
+	incremental = true;
+	has_tree = false;
+	set_artificial_cost();
+}
+
+// Largest arc cost (in absolute value) for which the artificial cost, and every potential and reduced cost, stays clear of overflow.
+long long NetworkSimplex::cost_limit() const
+{
+	return LLONG_MAX / 4 / (node_count + 1) - 1;
+}
+
+// Makes the artificial cost exceed the cost of any simple path of real arcs.  If some cost is beyond cost_limit(), there is no safe artificial cost, so it's set to -1 and solves fail.
+void NetworkSimplex::set_artificial_cost()
+{
+	long long limit = cost_limit();
+	long long max_cost = 0;
+	for (long a = 0; a < arc_count; a++)
+	{
+		if (cost[a] < -limit || cost[a] > limit)
+		{
+			art_cost = -1;
+			return;
+		}
+		max_cost = max(max_cost, llabs(cost[a]));
+	}
+	art_cost = (max_cost + 1) * (node_count + 1);
+}
+
+// Changes an instance arc's bounds for the next solve.
+void NetworkSimplex::set_bounds(long arc, long lb, long ub)
+{
+	lower[arc] = lb;
+	upper[arc] = ub;
+}
+
+// Changes the costs of the instance arcs for the next solve.  Artificial arcs in the last tree get the new artificial cost when the tree is repaired.  Returns 0 if successful, or -1 (leaving the costs alone) if some cost is beyond cost_limit().
+int NetworkSimplex::set_costs(const vector<long long> & costs)
+{
+	long long limit = cost_limit();
+	for (long a = 0; a < inst.DENSITY; a++)
+		if (costs[a] < -limit || costs[a] > limit)
+			return -1;
+	for (long a = 0; a < inst.DENSITY; a++)
+		cost[a] = costs[a];
+	set_artificial_cost();
+	return 0;
+}
+
+// Solves the current problem, from the last solve's tree if there is one.  Returns 0 if optimal, filling the objective, or -1 if infeasible, filling the certificate.  Also returns -1, with an empty certificate, if the costs are too large to solve with or the pivots run past their limit.
+int NetworkSimplex::solve(double & objective)
+{
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	stats = FlowStats();
+	cut.clear();
+	cut_excess = 0;
+	if (art_cost < 0)
+		return -1;
+
+	// Shift lower bounds into the supplies
+	supply = base_supply;
+	for (long a = 0; a < inst.DENSITY; a++)
+	{
+		if (upper[a] < lower[a])
+		{
+			// the arc alone is a certificate: both of its ends can't be satisfied
+			cut.push_back(source[a]);
+			cut_excess = lower[a] - upper[a];
+			return -1;
+		}
+		cap[a] = upper[a] - lower[a];
+		supply[source[a]] -= lower[a];
+		supply[target[a]] += lower[a];
+	}
+
+	// Start from the last tree, or from scratch
+	stats.incremental = (incremental && has_tree);
+	if (stats.incremental)
+		repair_tree();
+	else
+		init_tree();
+	has_tree = true;
+
+	// Pivot until no arc prices out.  A repaired tree may not be strongly feasible, so if it takes too long (in case it cycles) start again from scratch.  A solve from scratch can't cycle, so if that takes too long as well, something is wrong, and we give up.
+	long next_arc = 0;
+	long in_arc;
+	long limit = arc_count + node_count;
+	long scratch_limit = PIVOT_FACTOR * (arc_count + node_count);
+	long scratch_start = 0; // pivots before the solve from scratch began
+	while ((in_arc = find_entering(next_arc)) >= 0)
+	{
+		pivot(in_arc);
+		stats.pivots++;
+		if (stats.incremental && stats.pivots > limit)
+		{
+			stats.incremental = false;
+			init_tree();
+			scratch_start = stats.pivots;
+		}
+		else if (stats.incremental == false && stats.pivots - scratch_start > scratch_limit)
+		{
+			has_tree = false; // the tree is no use to the next solve
+			stats.time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+			return -1;
+		}
+	}
+
+	// Any flow left on an artificial arc means the supplies can't be met
+	for (long v = 0; v < node_count; v++)
+	{
+		if (flow[arc_count + v] > 0)
+		{
+			find_cut();
+			stats.time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+			return -1;
+		}
+	}
+
+	objective = 0;
+	for (long a = 0; a < inst.DENSITY; a++)
+		objective += (double)cost[a] * (flow[a] + lower[a]);
+	stats.time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	return 0;
+}
+
+// Copies out the flow on every instance arc.
+void NetworkSimplex::get_flow(vector<long> & x) const
+{
+	x.resize(inst.DENSITY);
+	for (long a = 0; a < inst.DENSITY; a++)
+		x[a] = (long)(flow[a] + lower[a]);
+}
+
+/*
+Builds the starting tree: every node hangs from the root by an artificial arc carrying its supply.  Nodes with nonnegative supply point up to the root at zero cost, and the others are fed from the root at the artificial cost, which makes the tree strongly feasible.
+*/
+void NetworkSimplex::init_tree()
+{
+	long root = node_count;
+	long total_arcs = arc_count + node_count;
+	flow.assign(total_arcs, 0);
+	state.assign(total_arcs, 1);
+	pi.assign(node_count + 1, 0);
+	parent.assign(node_count + 1, -1);
+	pred.assign(node_count + 1, -1);
+	pred_dir.assign(node_count + 1, 0);
+	depth.assign(node_count + 1, 0);
+	first_child.assign(node_count + 1, -1);
+	next_sibling.assign(node_count + 1, -1);
+	prev_sibling.assign(node_count + 1, -1);
+
+	for (long v = 0; v < node_count; v++)
+	{
+		long e = arc_count + v;
+		cap[e] = INF_CAP;
+		state[e] = 0;
+		if (supply[v] >= 0)
+		{
+			source[e] = v;
+			target[e] = root;
+			cost[e] = 0;
+			flow[e] = supply[v];
+			pred_dir[v] = 1;
+			pi[v] = 0;
+		}
+		else
+		{
+			source[e] = root;
+			target[e] = v;
+			cost[e] = art_cost;
+			flow[e] = -supply[v];
+			pred_dir[v] = -1;
+			pi[v] = art_cost;
+		}
+		pred[v] = e;
+		depth[v] = 1;
+		attach(v, root);
+	}
+}
+
+/*
+Rebuilds a basic solution for the current bounds on the last solve's tree.  Arcs outside the tree go to the bound given by their state, and the tree arcs' flows are worked out from the leaves up, each node sending its remaining imbalance through the arc to its parent.  A real tree arc that can't carry that much is left out of the tree at the bound it hit, and its node is hung from the root by its artificial arc instead, which carries the rest (leaving it to the big-M costs to price the artificial flow back out).  Potentials and depths are then recomputed from the root.
+*/
+void NetworkSimplex::repair_tree()
+{
+	long root = node_count;
+	long total_arcs = arc_count + node_count;
+
+	// Arcs outside the tree sit at a bound, and what's left at each node has to go through the tree
+	vector<long long> net(supply);
+	net.push_back(0);
+	for (long a = 0; a < total_arcs; a++)
+	{
+		if (state[a] == 0)
+			continue;
+		if (state[a] == -1 && cap[a] == 0)
+			state[a] = 1;
+		flow[a] = (state[a] == 1 ? 0 : cap[a]);
+		net[source[a]] -= flow[a];
+		net[target[a]] += flow[a];
+	}
+
+	// Tree order, so that every node comes after its parent
+	order.clear();
+	stack.clear();
+	stack.push_back(root);
+	while (stack.empty() == false)
+	{
+		long v = stack.back();
+		stack.pop_back();
+		order.push_back(v);
+		for (long c = first_child[v]; c >= 0; c = next_sibling[c])
+			stack.push_back(c);
+	}
+
+	// Tree flows, from the leaves up
+	for (long k = (long)order.size() - 1; k > 0; k--)
+	{
+		long v = order[k];
+		long p = parent[v];
+		long e = pred[v];
+		long long amount = net[v]; // what v has to send to its parent
+		if (e < arc_count)
+		{
+			long long f = pred_dir[v] * amount;
+			if (f >= 0 && f <= cap[e])
+			{
+				flow[e] = f;
+				net[p] += amount;
+				continue;
+			}
+
+			// Leave the arc at the bound it hit, and hang v from the root for the rest
+			flow[e] = (f < 0 ? 0 : cap[e]);
+			state[e] = (f < 0 ? 1 : -1);
+			net[p] += pred_dir[v] * flow[e];
+			amount -= pred_dir[v] * flow[e];
+			detach(v);
+			attach(v, root);
+			e = arc_count + v;
+			pred[v] = e;
+			stats.repairs++;
+		}
+
+		// The artificial arc points whichever way the rest has to go
+		if (amount >= 0)
+		{
+			source[e] = v;
+			target[e] = root;
+			cost[e] = 0;
+			pred_dir[v] = 1;
+		}
+		else
+		{
+			source[e] = root;
+			target[e] = v;
+			cost[e] = art_cost;
+			pred_dir[v] = -1;
+		}
+		flow[e] = (amount >= 0 ? amount : -amount);
+		state[e] = 0;
+	}
+
+	// Depths and potentials
+	for (long c = first_child[root]; c >= 0; c = next_sibling[c])
+		update_subtree(c);
+}
+
+/*
+Block search pricing: look through the real arcs a block at a time, starting where the last search stopped, and return the most violating arc of the first block that has one.  Returns -1 if the current tree is optimal.
+*/
+long NetworkSimplex::find_entering(long & next_arc)
+{
+	long block_size = max(10L, (long)sqrt((double)arc_count));
+	long long best = 0;
+	long in_arc = -1;
+	long count = block_size;
+	for (long k = 0; k < arc_count; k++)
+	{
+		long a = next_arc + k;
+		if (a >= arc_count)
+			a -= arc_count;
+		long long c = state[a] * (cost[a] + pi[source[a]] - pi[target[a]]);
+		if (c < best)
+		{
+			best = c;
+			in_arc = a;
+		}
+		if (--count == 0)
+		{
+			if (best < 0)
+			{
+				next_arc = a;
+				return in_arc;
+			}
+			count = block_size;
+		}
+	}
+	return in_arc;
+}
+
+/*
+Sends flow around the cycle that the entering arc closes, and exchanges it for the last blocking arc of the cycle (walking the cycle from its apex in the direction of the flow change).  If the entering arc is itself the blocking arc, it just moves to its other bound.
+*/
+void NetworkSimplex::pivot(long in_arc)
+{
+	// Find the apex of the cycle
+	long u = source[in_arc];
+	long v = target[in_arc];
+	while (u != v)
+	{
+		if (depth[u] >= depth[v])
+			u = parent[u];
+		else
+			v = parent[v];
+	}
+	long join = u;
+
+	// Flow moves from "first" to "second" across the entering arc
+	long first, second;
+	if (state[in_arc] == 1)
+	{
+		first = source[in_arc];
+		second = target[in_arc];
+	}
+	else
+	{
+		first = target[in_arc];
+		second = source[in_arc];
+	}
+	long long delta = cap[in_arc];
+	long u_out = -1;
+	int side = 0; // 1 if the leaving arc is between first and the apex, 2 if between second and the apex
+	for (long w = first; w != join; w = parent[w])
+	{
+		long e = pred[w];
+		long long d = (pred_dir[w] == 1 ? flow[e] : cap[e] - flow[e]);
+		if (d < delta)
+		{
+			delta = d;
+			u_out = w;
+			side = 1;
+		}
+	}
+	for (long w = second; w != join; w = parent[w])
+	{
+		long e = pred[w];
+		long long d = (pred_dir[w] == -1 ? flow[e] : cap[e] - flow[e]);
+		if (d <= delta)
+		{
+			delta = d;
+			u_out = w;
+			side = 2;
+		}
+	}
+
+	// Augment
+	if (delta > 0)
+	{
+		long long val = state[in_arc] * delta;
+		flow[in_arc] += val;
+		for (long w = source[in_arc]; w != join; w = parent[w])
+			flow[pred[w]] -= pred_dir[w] * val;
+		for (long w = target[in_arc]; w != join; w = parent[w])
+			flow[pred[w]] += pred_dir[w] * val;
+	}
+
+	if (side == 0)
+	{
+		state[in_arc] = -state[in_arc];
+		return;
+	}
+
+	// Exchange the arcs: the path from the entering arc's end (u_in) up to u_out is turned around and hung from the other end (v_in)
+	long u_in = (side == 1 ? first : second);
+	long v_in = (side == 1 ? second : first);
+	long out_arc = pred[u_out];
+	state[in_arc] = 0;
+	state[out_arc] = (flow[out_arc] == 0 ? 1 : -1);
+
+	long w = u_in;
+	long new_parent = v_in;
+	long new_pred = in_arc;
+	signed char new_dir = (source[in_arc] == u_in ? 1 : -1);
+	while (true)
+	{
+		long old_parent = parent[w];
+		long old_pred = pred[w];
+		signed char old_dir = pred_dir[w];
+		detach(w);
+		attach(w, new_parent);
+		pred[w] = new_pred;
+		pred_dir[w] = new_dir;
+		if (w == u_out)
+			break;
+		new_parent = w;
+		new_pred = old_pred;
+		new_dir = -old_dir;
+		w = old_parent;
+	}
+	update_subtree(u_in);
+}
+
+// Hangs a node from a new parent.
+void NetworkSimplex::attach(long v, long p)
+{
+	parent[v] = p;
+	prev_sibling[v] = -1;
+	next_sibling[v] = first_child[p];
+	if (first_child[p] >= 0)
+		prev_sibling[first_child[p]] = v;
+	first_child[p] = v;
+}
+
+// Removes a node from its parent's list of children.
+void NetworkSimplex::detach(long v)
+{
+	long p = parent[v];
+	if (prev_sibling[v] >= 0)
+		next_sibling[prev_sibling[v]] = next_sibling[v];
+	else
+		first_child[p] = next_sibling[v];
+	if (next_sibling[v] >= 0)
+		prev_sibling[next_sibling[v]] = prev_sibling[v];
+	parent[v] = -1;
+}
+
+// Recomputes depths and potentials below (and including) a node from its parent's.
+void NetworkSimplex::update_subtree(long top)
+{
+	stack.clear();
+	stack.push_back(top);
+	while (stack.empty() == false)
+	{
+		long v = stack.back();
+		stack.pop_back();
+		long p = parent[v];
+		depth[v] = depth[p] + 1;
+		pi[v] = pi[p] - pred_dir[v] * cost[pred[v]];
+		for (long c = first_child[v]; c >= 0; c = next_sibling[c])
+			stack.push_back(c);
+	}
+}
+
+/*
+Collects the Hoffman cut for an infeasible problem: the nodes reachable from unsent supply through arcs that could carry more flow (forward arcs below capacity, or backward arcs with flow).  At an optimal tree, no such path reaches a node whose demand is unmet, so the set's supply is more than its outgoing arcs can carry.
+*/
+void NetworkSimplex::find_cut()
+{
+	// Adjacency lists of the real and dump arcs
+	vector<long> out_start(node_count + 1, 0), in_start(node_count + 1, 0);
+	for (long a = 0; a < arc_count; a++)
+	{
+		out_start[source[a] + 1]++;
+		in_start[target[a] + 1]++;
+	}
+	for (long v = 0; v < node_count; v++)
+	{
+		out_start[v + 1] += out_start[v];
+		in_start[v + 1] += in_start[v];
+	}
+	vector<long> out_arcs(arc_count), in_arcs(arc_count);
+	vector<long> out_next(out_start.begin(), out_start.end() - 1), in_next(in_start.begin(), in_start.end() - 1);
+	for (long a = 0; a < arc_count; a++)
+	{
+		out_arcs[out_next[source[a]]++] = a;
+		in_arcs[in_next[target[a]]++] = a;
+	}
+
+	// Search from every node with unsent supply
+	vector<char> in_cut(node_count, 0);
+	for (long v = 0; v < node_count; v++)
+	{
+		long e = arc_count + v;
+		if (target[e] == node_count && flow[e] > 0)
+		{
+			in_cut[v] = 1;
+			cut.push_back(v);
+		}
+	}
+	for (size_t k = 0; k < cut.size(); k++)
+	{
+		long v = cut[k];
+		for (long j = out_start[v]; j < out_start[v + 1]; j++)
+		{
+			long a = out_arcs[j];
+			if (flow[a] < cap[a] && in_cut[target[a]] == 0)
+			{
+				in_cut[target[a]] = 1;
+				cut.push_back(target[a]);
+			}
+		}
+		for (long j = in_start[v]; j < in_start[v + 1]; j++)
+		{
+			long a = in_arcs[j];
+			if (flow[a] > 0 && in_cut[source[a]] == 0)
+			{
+				in_cut[source[a]] = 1;
+				cut.push_back(source[a]);
+			}
+		}
+	}
+
+	// Supply of the set minus the most that can leave it, in terms of the original bounds
+	cut_excess = 0;
+	for (long v : cut)
+		cut_excess += base_supply[v];
+	for (long a = 0; a < arc_count; a++)
+	{
+		long long lb = (a < inst.DENSITY ? lower[a] : 0);
+		long long ub = (a < inst.DENSITY ? upper[a] : cap[a]);
+		if (in_cut[source[a]] == 1 && in_cut[target[a]] == 0)
+			cut_excess -= ub;
+		if (in_cut[source[a]] == 0 && in_cut[target[a]] == 1)
+			cut_excess += lb;
+	}
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include <vector>
+#include "Instance.h"
+using namespace std;
+
+/*
+Interface for the engines that solve the network part of a rounded instance: the node balance constraints of the LP, with a lower and upper bound on every arc's flow.  Bounds start at [0,u] and are changed one arc at a time between solves.
+*/
+class FlowEngine
+{
+public:
+	virtual ~FlowEngine() {}
+	virtual void set_bounds(long, long, long) = 0; // set an arc's lower and upper flow bounds
+	virtual int solve(double&) = 0; // solve with the current bounds; output 0 and the objective if optimal, or -1 if infeasible
+	virtual void get_flow(vector<long>&) const = 0; // flow on each instance arc from the last successful solve
+	virtual void warm_start(const Result&) {} // start later solves from the LP relaxation's flows and basis, if the engine can use them
+};
+
+// Work done by a network simplex solve
+struct FlowStats
+{
+	bool incremental = false; // started from the last solve's tree instead of from scratch
+	long repairs = 0; // tree arcs that had to be replaced by artificial arcs to start from the last tree
+	long pivots = 0;
+	double time = 0; // seconds
+};
+
+/*
+Native primal network simplex for the rounded instances, so that no general LP solver is needed once every interdependency is fixed.
+
+The instance is turned into an ordinary min-cost flow problem first.  A ground node (numbered NODES) is added with demand equal to the total supply, and auxiliary arcs (negative head) end there instead of leaving the network.  When parents are nodes the source rows are ranges [0,b], so each source also gets a free "dump" arc to the ground node with capacity b, which carries whatever supply the source doesn't send.  Lower bounds are shifted out of the arcs into the node supplies.
+
+The simplex starts from an all-artificial spanning tree with big-M costs, and uses block search pricing with a strongly feasible tree (the leaving arc is the last blocking arc around the cycle), which prevents cycling; even so, a solve gives up (output -1, with no certificate) after far more pivots than it should need, and costs too large for the big-M arithmetic to stay clear of overflow are refused.  If some artificial arc still carries flow at the end, the problem is infeasible, and the nodes that can be reached from the unsent supply in the residual network form a Hoffman cut: every arc leaving the set is at its upper bound and every arc entering it is at its lower bound, yet the set's supply exceeds what can leave it.
+
+Later solves start from the last solve's tree, so that a few bound changes cost only a few pivots.  Each arc outside the tree stays at the same bound (lower or upper) under the new bounds, and the tree arcs carry whatever balances the nodes.  Where a tree arc can't carry that, the part of the tree below it is hung from the root by an artificial arc, and the big-M costs drive that flow back out as usual.  The arc costs can be changed too (as the Lagrangian solver does between its subproblems, see LagrangianSolver.h), which leaves the last tree's flows feasible and only changes the potentials.
+*/
+class NetworkSimplex : public FlowEngine
+{
+private:
+	const Instance & inst;
+	long node_count; // real nodes plus the ground node
+	long arc_count; // instance arcs plus dump arcs
+	long long art_cost; // cost of artificial arcs, more than any path of real arcs
+	vector<long> lower, upper; // current bounds of the instance arcs
+	vector<long long> base_supply; // supply of each node before shifting out lower bounds
+	// working network, with the root last and one artificial arc per node after the real arcs
+	vector<long> source, target;
+	vector<long long> cap, cost, flow, supply, pi;
+	vector<signed char> state; // 1 at lower bound, -1 at upper bound, 0 in the tree
+	// spanning tree
+	vector<long> parent, pred, depth;
+	vector<signed char> pred_dir; // 1 if the tree arc points from the node to its parent, -1 otherwise
+	vector<long> first_child, next_sibling, prev_sibling;
+	vector<long> stack; // scratch space for walking subtrees
+	// certificate
+	vector<long> cut;
+	long long cut_excess;
+	// warm starts
+	bool incremental; // whether solves start from the last tree
+	bool has_tree;
+	vector<long> order; // scratch space for listing the tree's nodes
+	FlowStats stats;
+	// methods
+	long long cost_limit() const;
+	void set_artificial_cost();
+	void init_tree();
+	void repair_tree();
+	long find_entering(long&);
+	void pivot(long);
+	void attach(long, long);
+	void detach(long);
+	void update_subtree(long);
+	void find_cut();
+public:
+	NetworkSimplex(const Instance&);
+	void set_bounds(long, long, long);
+	int solve(double&);
+	void get_flow(vector<long>&) const; // flow on each instance arc from the last solve
+	int set_costs(const vector<long long>&); // replace the cost of every instance arc; objectives are then in terms of the new costs; output -1 (with the costs unchanged) if any is too large to solve with
+	const vector<long>& get_cut() const { return cut; } // infeasibility certificate from the last solve: a set of node IDs (NODES being the ground node)
+	long long get_cut_excess() const { return cut_excess; } // supply of the cut set that can't leave it
+	const FlowStats& get_stats() const { return stats; } // work done by the last solve
+	void set_incremental(bool on) { incremental = on; } // start solves from the last tree (the default) or always from scratch
+};
@@ -0,0 +1,217 @@
+/*
+Reads a NETGEN .min file into an Instance.  The file is memory-mapped and scanned in place, with each number converted by from_chars, so no per-line strings or streams are created.  This replaces the readin() function that each solver used to carry, and fills the instance in exactly the same way.
+
+Lines are categorized by their first character:
+	c	comment (ignored)
+	p	min NODES DENSITY INTER PARENTS, where PARENTS is 'n' for nodes or 'a' for arcs
+	n	ID FLOW, listing all of the sources before any of the sinks
+	a	SRC DST LOW CAP COST
+	i	PARENT CHILD
+The numbers of sources and sinks are not stored in the file, so they are counted from the node lines.  The data lines must come in the order above, and a file is rejected unless it has exactly as many arcs and interdependencies as its problem line says, with every ID in range.
+
+Writing produces the same data lines as NETGEN (only nodes with nonzero supply are listed), but without the generator's parameter comments, which the instance doesn't keep.
+*/
+
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include "MappedFile.h"
+#include "MinFile.h"
+#include "Timer.h"
+using namespace std;
+
+// Skips spaces and tabs.
+static inline const char* skip_blanks(const char* p, const char* end)
+{
+	while (p < end && (*p == ' ' || *p == '\t'))
+		p++;
+	return p;
+}
+
+// Reads the next whitespace-separated integer on the line, advancing the pointer past it.  Returns false if there isn't one.
+static inline bool read_field(const char*& p, const char* end, long& value)
+{
+	p = skip_blanks(p, end);
+	from_chars_result parsed = from_chars(p, end, value);
+	if (parsed.ec != errc())
+		return false;
+	p = parsed.ptr;
+	return true;
+}
+
+// Reads specified input file.  Returns 0 if successful.
+int read_min(string input_name, Instance & inst)
+{
+	PhaseTimer timer(PHASE_PARSE);
+	MappedFile file;
+	if (file.open(input_name) != 0)
+		return -1;
+
+	inst.NODES = inst.DENSITY = inst.INTER = 0;
+	inst.SOURCES = inst.SINKS = 0;
+	inst.PARENT = 0;
+	int phase = 0; // 0 for objective, 1 for sources, 2 for sinks, 3 for arcs, 4 for interdependencies
+	long counter = 0; // counter for node or arc number
+	const char* p = file.begin();
+	const char* end = file.end();
+	while (p < end)
+	{
+		// Find the end of the current line
+		const char* line_end = (const char*)memchr(p, '\n', end - p);
+		if (line_end == nullptr)
+			line_end = end;
+		long id, value, tail, head, cap, cost, parent_id, child_id; // numbers read from line
+
+		// Categorize type of line based on the first character
+		switch (*p)
+		{
+		// Ignore comments (c)
+		case 'p': // min NODES DENSITY INTER PARENT
+			if (phase != 0)
+				return -1; // only one problem line, before everything else
+			p = skip_blanks(p + 1, line_end);
+			if (line_end - p < 3 || memcmp(p, "min", 3) != 0)
+				return -1; // maximum flow problems have no costs or interdependencies
+			p += 3;
+			if (read_field(p, line_end, inst.NODES) == false || read_field(p, line_end, inst.DENSITY) == false || read_field(p, line_end, inst.INTER) == false)
+				return -1;
+			if (inst.NODES < 0 || inst.DENSITY < 0 || inst.INTER < 0)
+				return -1;
+			p = skip_blanks(p, line_end);
+			if (p < line_end && *p == 'a')
+				inst.PARENT = 1;
+			else
+				inst.PARENT = 0;
+			inst.b.assign(inst.NODES, 0);
+			inst.tail.resize(inst.DENSITY);
+			inst.head.resize(inst.DENSITY);
+			inst.u.resize(inst.DENSITY);
+			inst.c.resize(inst.DENSITY);
+			inst.parent.resize(inst.INTER);
+			inst.child.resize(inst.INTER);
+			phase = 1;
+			break;
+		case 'n': // n ID FLOW
+			p++;
+			if (phase < 1 || phase > 2 || read_field(p, line_end, id) == false || read_field(p, line_end, value) == false)
+				return -1; // nodes come before the arcs
+			if (value > 0 && phase == 2)
+				return -1; // sources come before the sinks, or they'd be miscounted
+			if (id < 1 || id > inst.NODES)
+				return -1;
+			inst.b[id - 1] = value;
+			if (value < 0 && phase == 1)
+			{
+				// we've just hit the first sink
+				phase = 2;
+				inst.SOURCES = counter;
+				counter = 0;
+			}
+			counter++;
+			break;
+		case 'a': // a SRC DST LOW CAP COST
+			if (phase < 1 || phase > 3)
+				return -1; // arcs come before the interdependencies
+			if (phase == 1)
+			{
+				// there were no sinks
+				phase = 2;
+				inst.SOURCES = counter;
+				counter = 0;
+			}
+			if (phase == 2)
+			{
+				// we've just hit the first arc
+				phase = 3;
+				inst.SINKS = counter;
+				counter = 0;
+			}
+			p++;
+			if (read_field(p, line_end, tail) == false || read_field(p, line_end, head) == false || read_field(p, line_end, value) == false
+				|| read_field(p, line_end, cap) == false || read_field(p, line_end, cost) == false)
+				return -1;
+			if (counter >= inst.DENSITY || tail < 1 || tail > inst.NODES || head < 0 || head > inst.NODES) // a head of 0 marks an auxiliary arc
+				return -1;
+			inst.tail[counter] = tail - 1;
+			inst.head[counter] = head - 1;
+			inst.u[counter] = cap;
+			inst.c[counter] = cost;
+			counter++;
+			break;
+		case 'i': // i parent child
+			if (phase < 3)
+				return -1;
+			if (phase == 3)
+			{
+				// we've just hit the first interdependency, so every arc should have been read
+				if (counter != inst.DENSITY)
+					return -1;
+				phase = 4;
+				counter = 0;
+			}
+			p++;
+			if (read_field(p, line_end, parent_id) == false || read_field(p, line_end, child_id) == false)
+				return -1;
+			if (counter >= inst.INTER || parent_id < 1 || parent_id > inst.DENSITY || child_id < 1 || child_id > inst.DENSITY)
+				return -1;
+			inst.parent[counter] = parent_id - 1;
+			inst.child[counter] = child_id - 1;
+			counter++;
+			break;
+		}
+		p = line_end + 1;
+	}
+
+	// Finish the counts if the file ended early
+	if (phase == 1)
+		inst.SOURCES = counter;
+	if (phase == 1 || phase == 2)
+		inst.SINKS = (phase == 2 ? counter : 0);
+
+	// Every arc and interdependency that the problem line promised must have been read, as in read_bin()
+	if (phase == 0)
+		return -1;
+	if (phase <= 2 && (inst.DENSITY != 0 || inst.INTER != 0))
+		return -1;
+	if (phase == 3 && (counter != inst.DENSITY || inst.INTER != 0))
+		return -1;
+	if (phase == 4 && counter != inst.INTER)
+		return -1;
+	return 0;
+}
+
+// Writes the instance to a .min file.  Returns 0 if successful.
+int write_min(string file_name, const Instance & inst)
+{
+	PhaseTimer timer(PHASE_WRITE);
+	ofstream outfile;
+	outfile.open(file_name);
+	if (outfile.is_open() == false)
+		return -1;
+
+	outfile << "c NETGEN flow network generator (C++ version)\n";
+	outfile << "c Modified to generate interdependent networks\n";
+	outfile << "c\n";
+	outfile << "c  *** Minimum cost flow ***\n";
+	outfile << "c\n";
+	outfile << "p min " << inst.NODES << ' ' << inst.DENSITY << ' ' << inst.INTER;
+	if (inst.PARENT == 0)
+		outfile << " n\n";
+	else
+		outfile << " a\n";
+	for (long i = 0; i < inst.NODES; i++)
+	{
+		if (inst.b[i] != 0)
+			outfile << "n " << i + 1 << ' ' << inst.b[i] << '\n';
+	}
+	for (long i = 0; i < inst.DENSITY; i++)
+		outfile << "a " << inst.tail[i] + 1 << ' ' << inst.head[i] + 1 << " 0 " << inst.u[i] << ' ' << inst.c[i] << '\n';
+	for (long i = 0; i < inst.INTER; i++)
+		outfile << "i " << inst.parent[i] + 1 << ' ' << inst.child[i] + 1 << '\n';
+
+	bool ok = outfile.good();
+	outfile.close();
+	if (ok == false)
+		return -1;
+	return 0;
+}
@@ -0,0 +1,10 @@
+#pragma once
+#include <string>
+#include "Instance.h"
+using namespace std;
+
+/*
+Reader and writer for the .min files written by NETGEN, shared by all of the solvers.
+*/
+int read_min(string, Instance&); // read specified .min file into an instance; output 0 if it worked, or -1 if not
+int write_min(string, const Instance&); // write instance to specified .min file; output 0 if it worked, or -1 if not
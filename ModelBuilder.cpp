@@ -0,0 +1,90 @@
+/*
+Bulk construction of the network part of the CPLEX models (see ModelBuilder.h).
+*/
+
+#include "ilcplex\cplex.h"
+#include "ilcplex\ilocplex.h"
+#include "ModelBuilder.h"
+using namespace std;
+
+// Counts the entries of each row, then places every arc's entries in arc order.
+NetworkMatrix::NetworkMatrix(const Instance & inst)
+{
+	row_start.assign(inst.NODES + 1, 0);
+	for (long i = 0; i < inst.DENSITY; i++)
+	{
+		row_start[inst.tail[i] + 1]++;
+		if (inst.head[i] >= 0)
+			row_start[inst.head[i] + 1]++;
+	}
+	for (long v = 0; v < inst.NODES; v++)
+		row_start[v + 1] += row_start[v];
+
+	arc.resize(row_start[inst.NODES]);
+	coef.resize(row_start[inst.NODES]);
+	vector<long> next(row_start.begin(), row_start.end() - 1); // next free entry of each row
+	for (long i = 0; i < inst.DENSITY; i++)
+	{
+		long k = next[inst.tail[i]]++;
+		arc[k] = i;
+		coef[k] = 1; // tail coefficient
+		if (inst.head[i] >= 0)
+		{
+			k = next[inst.head[i]]++;
+			arc[k] = i;
+			coef[k] = -1; // head coefficient (only applies to non-auxiliary arcs)
+		}
+	}
+}
+
+// Builds the flow columns, balance rows and objective in bulk.
+void build_network(IloEnv env, IloModel model, const Instance & inst, const NetworkMatrix & matrix, IloNumVarArray & x, IloRangeArray & con1, IloObjective & obj)
+{
+	// Variables and bounds
+	IloNumArray lbs(env, inst.DENSITY);
+	IloNumArray ubs(env, inst.DENSITY);
+	IloNumArray costs(env, inst.DENSITY);
+	for (long i = 0; i < inst.DENSITY; i++)
+	{
+		lbs[i] = 0;
+		ubs[i] = inst.u[i];
+		costs[i] = inst.c[i];
+	}
+	x = IloNumVarArray(env, lbs, ubs, ILOFLOAT);
+
+	// Network constraints
+	IloNumArray row_lbs(env, inst.NODES);
+	IloNumArray row_ubs(env, inst.NODES);
+	for (long v = 0; v < inst.NODES; v++)
+	{
+		row_lbs[v] = (inst.PARENT == 0 && v < inst.SOURCES ? 0 : inst.b[v]); // relax source supply values if we're using nodes as parents
+		row_ubs[v] = inst.b[v]; // otherwise, it's an equality constraint
+	}
+	con1 = IloRangeArray(env, row_lbs, row_ubs);
+	for (long v = 0; v < inst.NODES; v++)
+	{
+		long size = matrix.row_start[v + 1] - matrix.row_start[v];
+		IloNumVarArray row_x(env);
+		IloNumArray row_coefs(env, size);
+		for (long k = 0; k < size; k++)
+		{
+			row_x.add(x[matrix.arc[matrix.row_start[v] + k]]);
+			row_coefs[k] = matrix.coef[matrix.row_start[v] + k];
+		}
+		con1[v].setLinearCoefs(row_x, row_coefs);
+		row_x.end();
+		row_coefs.end();
+	}
+	model.add(con1);
+
+	// Objective
+	obj = IloMinimize(env);
+	obj.setLinearCoefs(x, costs);
+	model.add(obj);
+
+	lbs.end();
+	ubs.end();
+	costs.end();
+	row_lbs.end();
+	row_ubs.end();
+}
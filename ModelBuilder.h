@@ -0,0 +1,21 @@
+#pragma once
+#include <vector>
+#include "ilcplex\ilocplex.h"
+#include "Instance.h"
+using namespace std;
+
+/*
+The node-arc incidence matrix of an instance, in compressed sparse row form: one row per node, holding a +1 for each arc leaving it and a -1 for each arc entering it (auxiliary arcs, with a negative head, only have the +1).  The entries of each row are in arc order.  It's built in one linear pass over the arcs, and one matrix can be shared by every model built from the same instance.
+*/
+struct NetworkMatrix
+{
+	vector<long> row_start; // row i holds entries row_start[i] to row_start[i+1]-1
+	vector<long> arc; // column of each entry
+	vector<double> coef; // coefficient of each entry
+	NetworkMatrix(const Instance&);
+};
+
+/*
+Adds the network part of an LP, MILP or RR model: one flow column per arc with its capacity as the upper bound, one balance row per node (with the source supplies relaxed to upper bounds when the parents are sink nodes), and the arc costs as a minimization objective.  Rather than setting coefficients one at a time, the columns and rows are each created with one bulk call, every row is filled from the matrix with one call, and so is the objective.  Fills the given arrays and objective, which are also added to the model.
+*/
+void build_network(IloEnv, IloModel, const Instance&, const NetworkMatrix&, IloNumVarArray&, IloRangeArray&, IloObjective&);
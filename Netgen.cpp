@@ -5,6 +5,8 @@ Two additional values are added to the objective line: the number of interdepend
 The interdependencies are reported at the end of the .min file, using the syntax "i PARENT CHILD", where PARENT is a node/arc ID and CHILD is an arc number.
 
 Edit: If we are using nodes as parents, then instead of reporting the node ID, we generate a new arc and report its ID.
+
+Edit: If the output file name ends in .bin, the network is written in the binary instance format (see BinFile.h) instead of as a .min file.
 */
 
 /*** Copyright 1989 Norbert Schlenker.  All rights reserved.
@@ -90,87 +92,20 @@ Edit: If we are using nodes as parents, then instead of reporting the node ID, w
 #include <iostream>
 #include <string>
 #include <fstream>
-//#include <vector>
-#include "NetgenRandom.h"
-#include "NetgenIndex.h"
+#include <climits>
+#include <new>
+#include "BinFile.h"
+#include "Netgen.h"
+#include "Timer.h"
 using namespace std;
 
-// parameters
-string file_name; // output file
-long seed; // RNG seed
-long NODES; // number of nodes
-long SOURCES; // number of sources (including transshipment)
-long SINKS; // number of sinks (including transshipment)
-long DENSITY; // number of (requested) arcs
-long MINCOST; // minimum cost of arcs
-long MAXCOST; // maximum cost of arcs
-long SUPPLY; // total supply
-long TSOURCES; // transshipment sources
-long TSINKS; // transshipment sinks
-long HICOST; // percent of skeleton arcs given maximum cost
-long CAPACITATED; // percent of arcs to be capacitated
-long MINCAP; // minimum capacity for capacitated arcs
-long MAXCAP; // maximum capacity for capacitated arcs
-int PARENT; // 0 if parents are sink nodes, 1 if parents are arcs
-long INTER; // number of interdependencies
-// maximum problem sizes
-#define MAXNODES 5000
-#define MAXARCS 60000
-// error indicators
-#define BAD_SEED -1
-#define TOO_BIG -2
-#define BAD_PARMS -3
-#define ALLOCATION_FAILURE -4
 // max/min methods
 #define MAX(a, b) (((a)>(b))?(a):(b))
 #define MIN(a, b) (((a)<(b))?(a):(b))
-// types
-typedef unsigned long NODE; // node number
-typedef unsigned long ARC; // arc number
-typedef long CAPACITY; // arc capacity
-typedef long COST; // arc cost
-typedef unsigned long INDEX; // index element
-typedef int INDEX_LIST; // index list handle
-// methods
-void create_supply(NODE, CAPACITY); //create supply nodes
-void sort_skeleton(int); // sort skeleton chains
-void pick_head(NetgenIndex*, NODE); // pick destination for rubbish arcs
-void error_exit(int); // print error message and exits
-// variables
-NODE nodes_left;
-ARC arc_count;
-/*vector<NODE> pred; // predecessors in the linked list representation of the skeleton arcs
-vector<NODE> head; // skeleton arc heads
-vector<NODE> tail; // skeleton arc tails
-vector<NODE> FROM; // arc origins
-vector<NODE> TO; // arc destinations
-vector<CAPACITY> U; // capacity
-vector<COST> C; // cost
-vector<CAPACITY> B; // node supply (demand) values
-vector<ARC> child; // child arcs
-vector<long> parent; // parent nodes/arcs*/
-NODE pred[MAXNODES];
-NODE head[MAXARCS];
-NODE tail[MAXARCS];
-NODE FROM[MAXARCS];
-NODE TO[MAXARCS];
-CAPACITY U[MAXARCS];
-COST C[MAXARCS];
-CAPACITY B[MAXNODES];
-ARC child[MAXARCS];
-long parent[MAXARCS];
-const int delivery_cost = -100; // "reward" for delivering to a parent node
-// RNG
-//NetgenRandom * rando = new NetgenRandom();
-NetgenRandom rando;
-int netgen(); // try to build network; output arc count if it worked, or an error code if not
-void printout(); // print the network to a specified file name
-void node_parents(); // transform parent nodes into transshipment nodes, and add auxiliary arcs
 
+#ifndef MCNFLI_LIB
 int main(int argc, char* argv[])
 {
-
-
 	if (argc != 18)
 	{
 		cout << "Expecting the following 17 arguments:\n";
@@ -180,70 +115,58 @@ int main(int argc, char* argv[])
 	}
 	else
 	{
-		// Save parameters as global varialbes
-		file_name = argv[1];
-		seed = stoi(argv[2]);
-		rando.set_random(seed);
-		NODES = stoi(argv[3]);
-		SOURCES = stoi(argv[4]);
-		SINKS = stoi(argv[5]);
-		DENSITY = stoi(argv[6]);
-		MINCOST = stoi(argv[7]);
-		MAXCOST = stoi(argv[8]);
-		SUPPLY = stoi(argv[9]);
-		TSOURCES = stoi(argv[10]);
-		TSINKS = stoi(argv[11]);
-		HICOST = stoi(argv[12]);
-		CAPACITATED = stoi(argv[13]);
-		MINCAP = stoi(argv[14]);
-		MAXCAP = stoi(argv[15]);
-		PARENT = stoi(argv[16]);
-		INTER = stoi(argv[17]);
-
-		printout();
+		// Save parameters in a generator object
+		Netgen * gen = new Netgen(stoi(argv[2]), stoi(argv[3]), stoi(argv[4]), stoi(argv[5]), stoi(argv[6]), stoi(argv[7]), stoi(argv[8]),
+			stoi(argv[9]), stoi(argv[10]), stoi(argv[11]), stoi(argv[12]), stoi(argv[13]), stoi(argv[14]), stoi(argv[15]), stoi(argv[16]), stoi(argv[17]));
+
+		int rc = gen->printout(argv[1]);
+		delete gen;
+		if (timing_enabled)
+			thread_phase_times().print(cout);
+		if (rc < 0)
+		{
+			Netgen::error_message(rc);
+			return 1000 - rc;
+		}
 		return 0;
 	}
-
-	/*seed = 477021979; // To add: read in custom parameters; generate interdependencies; try looping or calling .exe from another program
-	NODES = 256;
-	SOURCES = 52;
-	SINKS = 52;
-	DENSITY = 1024;
-	MINCOST = 1;
-	MAXCOST = 100;
-	SUPPLY = 20000;
-	TSOURCES = 0;
-	TSINKS = 0;
-	HICOST = 100;
-	CAPACITATED = 100;
-	MINCAP = 100;
-	MAXCAP = 500;*/
-
-	//rando->set_random(seed);
-	//rando.set_random(seed);
-
-	//printout("test.min");
-
-	//return 0;
 }
+#endif
 
-/*Netgen::~Netgen()
+Netgen::Netgen(long rng_seed, long nodes, long sources, long sinks, long density, long mincost, long maxcost, long supply,
+	long tsources, long tsinks, long hicost, long capacitated, long mincap, long maxcap, int parent_type, long inter)
 {
-delete rando;
-}*/
+	seed = rng_seed;
+	NODES = nodes;
+	SOURCES = sources;
+	SINKS = sinks;
+	DENSITY = density;
+	MINCOST = mincost;
+	MAXCOST = maxcost;
+	SUPPLY = supply;
+	TSOURCES = tsources;
+	TSINKS = tsinks;
+	HICOST = hicost;
+	CAPACITATED = capacitated;
+	MINCAP = mincap;
+	MAXCAP = maxcap;
+	PARENT = parent_type;
+	INTER = inter;
+}
 
 // The main method
-int netgen()
+long long Netgen::netgen()
 {
 	NODE i, j, k, source, node, sinks_per_source, it;
-	int chain_length, supply_per_sink, partial_supply, sort_count;
+	long long chain_length, sort_count;
+	CAPACITY supply_per_sink, partial_supply;
 	COST cost;
 	CAPACITY cap;
 
 	// Perform sanity checks on the input
 	if (seed <= 0)
 		return BAD_SEED;
-	if (NODES > MAXNODES || DENSITY > MAXARCS)
+	if (NODES >= INT_MAX || DENSITY >= INT_MAX / 2) // index lists (and the solvers) count nodes and arcs with ints
 		return TOO_BIG;
 	if (NODES <= 0 ||
 		NODES > DENSITY ||
@@ -263,16 +186,28 @@ int netgen()
 		return BAD_PARMS;
 
 	// Setting up
-	/*pred.resize(ceil(1.1 * DENSITY)); // giving the main arrays a bit of extra room
-	head.resize(ceil(1.1 * DENSITY));
-	tail.resize(ceil(1.1 * DENSITY));
-	FROM.resize(ceil(1.1 * DENSITY));
-	TO.resize(ceil(1.1 * DENSITY));
-	U.resize(ceil(1.1 * DENSITY));
-	C.resize(ceil(1.1 * DENSITY));
-	B.resize(ceil(1.1 * NODES));
-	parent.resize(INTER);
-	child.resize(INTER);*/
+	try
+	{
+		pred.assign(NODES + 1, 0);
+		head.assign(NODES + 2, 0); // a chain and its sinks hold at most NODES nodes, plus room for an end marker
+		tail.assign(NODES + 2, 0);
+		B.assign(NODES, 0); // supplies accumulate, so they must start at zero on every run
+		parent.assign(INTER, 0);
+		child.assign(INTER, 0);
+		FROM.clear(); // arcs are appended as they are generated
+		TO.clear();
+		U.clear();
+		C.clear();
+		FROM.reserve(DENSITY + INTER);
+		TO.reserve(DENSITY + INTER);
+		U.reserve(DENSITY + INTER);
+		C.reserve(DENSITY + INTER);
+	}
+	catch (bad_alloc &)
+	{
+		return ALLOCATION_FAILURE;
+	}
+	rando.set_random(seed);
 	arc_count = 0; // running tally of arcs generated
 	nodes_left = NODES - SINKS + TSINKS; // running tally of nodes left to generate
 	create_supply(SOURCES, SUPPLY);
@@ -326,8 +261,7 @@ int netgen()
 		else
 			sinks_per_source = 2 * sort_count * SINKS / (NODES - SOURCES - SINKS); // scale with length of chain (longer means more)
 		sinks_per_source = MAX(2, MIN(sinks_per_source, SINKS)); // restricting to reasonable bounds
-		//vector<NODE> sinks(sinks_per_source + 1); // list of the sinks we'll be connecting
-		NODE sinks[MAXNODES];
+		vector<NODE> sinks(SINKS + 2); // list of the sinks we'll be connecting (at least 2 are chosen, even if there is only 1)
 		NetgenIndex * indie = new NetgenIndex(NODES - SINKS, NODES - 1);
 		for (i = 0; i < sinks_per_source; i++)
 			//sinks[i] = indie->choose_index(rando->random(1, indie->index_size())); // choose sinks for the list without repetition
@@ -388,12 +322,7 @@ int netgen()
 				if (rando.random(1, 100) > HICOST)
 					//cost = rando->random(MINCOST, MAXCOST); // if not, just randomly roll for cost
 					cost = rando.random(MINCOST, MAXCOST);
-				//SAVE_ARC(it, head[i], cost, cap)
-				FROM[arc_count] = it;
-				TO[arc_count] = head[i];
-				C[arc_count] = cost;
-				U[arc_count] = cap;
-				arc_count++;
+				save_arc(it, head[i], cost, cap);
 				i++;
 			}
 			pick_head(indie, it);
@@ -438,7 +367,7 @@ int netgen()
 }
 
 // set up supply values (B) for the supply nodes
-void create_supply(NODE sources, CAPACITY supply)
+void Netgen::create_supply(NODE sources, CAPACITY supply)
 {
 	CAPACITY supply_per_source = supply / sources;
 	CAPACITY partial_supply;
@@ -456,9 +385,10 @@ void create_supply(NODE sources, CAPACITY supply)
 	B[rando.random(0, sources - 1)] += supply % sources;
 }
 
-void sort_skeleton(int sort_count) 		/* Shell sort */
+void Netgen::sort_skeleton(long long sort_count) 		/* Shell sort */
 {
-	int m, i, j, k, temp;
+	long long m, i, j, k;
+	NODE temp;
 
 	m = sort_count;
 	while ((m /= 2) != 0)
@@ -481,7 +411,7 @@ void sort_skeleton(int sort_count) 		/* Shell sort */
 	}
 }
 
-void pick_head(NetgenIndex*indie, NODE desired_tail)
+void Netgen::pick_head(NetgenIndex*indie, NODE desired_tail)
 {
 	NODE non_sources = NODES - SOURCES + TSOURCES;
 	ARC remaining_arcs;
@@ -490,8 +420,8 @@ void pick_head(NetgenIndex*indie, NODE desired_tail)
 	else
 		remaining_arcs = DENSITY - arc_count;
 	INDEX index;
-	int limit;
-	long upper_bound;
+	long long limit;
+	long long upper_bound;
 	CAPACITY cap;
 
 	nodes_left--;
@@ -522,33 +452,35 @@ void pick_head(NetgenIndex*indie, NODE desired_tail)
 			//cap = rando->random(MINCAP, MAXCAP);
 			cap = rando.random(MINCAP, MAXCAP);
 		//SAVE_ARC(desired_tail, index, random(MINCOST, MAXCOST), cap);
-		FROM[arc_count] = desired_tail;
-		TO[arc_count] = index;
-		//C[arc_count] = rando->random(MINCOST, MAXCOST);
-		C[arc_count] = rando.random(MINCOST, MAXCOST);
-		U[arc_count] = cap;
-		arc_count++;
+		save_arc(desired_tail, index, rando.random(MINCOST, MAXCOST), cap);
 	}
 }
 
 // Conduct transformations to rewrite parent nodes as parent arcs, which involves adding auxiliary arcs.
-void node_parents()
+void Netgen::node_parents()
 {
 	// process each parent node
 	for (int i = 0; i < INTER; i++)
 	{
-		FROM[arc_count] = parent[i]; // new arc tail
-		TO[arc_count] = 0; // new arc head doesn't matter
-		U[arc_count] = -B[parent[i] - 1]; // new arc's capacity is old node's demand
-		C[arc_count] = delivery_cost; // new arc's cost is the delivery reward
+		// new arc starts at the parent (its head doesn't matter), with the old node's demand as capacity and the delivery reward as cost
+		save_arc(parent[i], 0, delivery_cost, -B[parent[i] - 1]);
 		B[parent[i] - 1] = 0; // turn parent node into transshipment
-		parent[i] = arc_count + 1; // new arc ID
-		arc_count++;
+		parent[i] = arc_count; // new arc ID
 	}
 }
 
-/*** Print an appropriate error message and then exit with a nonzero code. */
-void error_exit(int rc)
+/*** Append an arc to the network (the SAVE_ARC macro of the original code). */
+void Netgen::save_arc(NODE from, NODE to, COST cost, CAPACITY cap)
+{
+	FROM.push_back(from);
+	TO.push_back(to);
+	C.push_back(cost);
+	U.push_back(cap);
+	arc_count++;
+}
+
+/*** Print an appropriate error message.  The caller decides whether to exit. */
+void Netgen::error_message(int rc)
 {
 	switch (rc)
 	{
@@ -564,21 +496,110 @@ void error_exit(int rc)
 	case ALLOCATION_FAILURE:
 		cout << "Memory allocation failure\n";
 		break;
+	case WRITE_FAILURE:
+		cout << "Unable to write the network to the output file\n";
+		break;
 	default:
 		cout << "Internal error\n";
 		break;
 	}
-	exit(1000 - rc);
 }
 
-// Printing the network to a specified file.
-void printout()
+// Build the network and copy it into an instance, exactly as the solvers would read it from the printed .min file.
+int Netgen::generate(Instance & inst)
 {
+	PhaseTimer timer(PHASE_GENERATE);
+	long long arcs = netgen();
+	if (arcs < 0)
+		return (int)arcs;
+
+	inst.NODES = NODES;
+	inst.DENSITY = arcs;
+	inst.INTER = INTER;
+	inst.PARENT = PARENT;
+
+	// Node supplies, counting sources and sinks the same way the .min reader does (only nonzero nodes are printed)
+	int phase = 1; // 1 for sources, 2 for sinks
+	int counter = 0;
+	inst.SOURCES = 0;
+	inst.b.assign(NODES, 0);
+	for (int i = 0; i < NODES; i++)
+	{
+		if (B[i] == 0)
+			continue;
+		inst.b[i] = B[i];
+		if (B[i] < 0 && phase == 1)
+		{
+			// we've just hit the first sink
+			phase = 2;
+			inst.SOURCES = counter;
+			counter = 0;
+		}
+		counter++;
+	}
+	if (phase == 1)
+	{
+		// there were no sinks
+		inst.SOURCES = counter;
+		counter = 0;
+	}
+	inst.SINKS = counter;
+
+	// Arcs (a head of 0 marks an auxiliary arc, which becomes a negative head)
+	inst.tail.resize(arcs);
+	inst.head.resize(arcs);
+	inst.u.resize(arcs);
+	inst.c.resize(arcs);
+	for (int i = 0; i < arcs; i++)
+	{
+		inst.tail[i] = FROM[i] - 1;
+		inst.head[i] = (long)TO[i] - 1;
+		inst.u[i] = U[i];
+		inst.c[i] = C[i];
+	}
+
+	// Interdependencies
+	inst.parent.resize(INTER);
+	inst.child.resize(INTER);
+	for (int i = 0; i < INTER; i++)
+	{
+		inst.parent[i] = parent[i] - 1;
+		inst.child[i] = child[i] - 1;
+	}
+
+	return 0;
+}
+
+// Printing the network to a specified file.  Returns 0 if successful, an error code from netgen() if generation failed, or WRITE_FAILURE if the file failed to open.
+int Netgen::printout(string file_name)
+{
+	// file names ending in .bin get the binary instance format instead of .min text
+	if (file_name.size() >= 4 && file_name.compare(file_name.size() - 4, 4, ".bin") == 0)
+	{
+		Instance inst;
+		int rc = generate(inst);
+		if (rc < 0)
+			return rc;
+		if (write_bin(file_name, inst) != 0)
+		{
+			cout << "Unable to write to file " << file_name << ".\n";
+			return WRITE_FAILURE;
+		}
+		return 0;
+	}
+
+	// actually run NETGEN, and get the number of arcs from the output (negative output indicates an error)
+	PhaseTimer timer(PHASE_GENERATE);
+	long long arcs = netgen();
+	if (arcs < 0)
+		return (int)arcs;
+
+	timer.next(PHASE_WRITE);
 	ofstream outfile;
 	outfile.open(file_name);
 	if (outfile.is_open() == true)
 	{
-		int i;
+		long long i;
 
 		outfile << "c NETGEN flow network generator (C++ version)\n";
 		outfile << "c Modified to generate interdependent networks\n";
@@ -606,11 +627,6 @@ void printout()
 			outfile << "c     Parents:            Arcs\n";
 		outfile << "c     Number:             " << INTER << "\n";
 
-		// actually run NETGEN, and get the number of arcs from the output (negative output indicates an error)
-		int arcs = netgen();
-		if (arcs < 0)
-			error_exit(arcs);
-
 		if (MINCOST == 1 && MAXCOST == 1)
 		{
 			outfile << "c\n";
@@ -654,7 +670,10 @@ void printout()
 		outfile.close();
 	}
 	else
+	{
 		cout << "Unable to write to file " << file_name << ".\n";
+		return WRITE_FAILURE;
+	}
 
-	exit(0);
+	return 0;
 }
\ No newline at end of file
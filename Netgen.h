@@ -0,0 +1,73 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "NetgenRandom.h"
+#include "NetgenIndex.h"
+#include "Instance.h"
+using namespace std;
+
+// error indicators
+#define BAD_SEED -1
+#define TOO_BIG -2
+#define BAD_PARMS -3
+#define ALLOCATION_FAILURE -4
+#define WRITE_FAILURE -5
+// types
+typedef unsigned long long NODE; // node number (64 bits, since some products of node counts overflow 32 bits on large networks)
+typedef unsigned long long ARC; // arc number
+typedef long CAPACITY; // arc capacity
+typedef long COST; // arc cost
+typedef unsigned long INDEX; // index element
+typedef int INDEX_LIST; // index list handle
+
+/*
+The generator's parameters and working arrays, so that several networks can be generated within one process.  The arrays are sized for each run, so memory use is proportional to the network being generated.
+*/
+class Netgen
+{
+private:
+	// parameters
+	long seed; // RNG seed
+	long NODES; // number of nodes
+	long SOURCES; // number of sources (including transshipment)
+	long SINKS; // number of sinks (including transshipment)
+	long DENSITY; // number of (requested) arcs
+	long MINCOST; // minimum cost of arcs
+	long MAXCOST; // maximum cost of arcs
+	long SUPPLY; // total supply
+	long TSOURCES; // transshipment sources
+	long TSINKS; // transshipment sinks
+	long HICOST; // percent of skeleton arcs given maximum cost
+	long CAPACITATED; // percent of arcs to be capacitated
+	long MINCAP; // minimum capacity for capacitated arcs
+	long MAXCAP; // maximum capacity for capacitated arcs
+	int PARENT; // 0 if parents are sink nodes, 1 if parents are arcs
+	long INTER; // number of interdependencies
+	// variables
+	NODE nodes_left;
+	ARC arc_count;
+	vector<NODE> pred; // predecessors in the linked list representation of the skeleton arcs
+	vector<NODE> head; // skeleton arc heads
+	vector<NODE> tail; // skeleton arc tails
+	vector<NODE> FROM; // arc origins
+	vector<NODE> TO; // arc destinations
+	vector<CAPACITY> U; // capacity
+	vector<COST> C; // cost
+	vector<CAPACITY> B; // node supply (demand) values
+	vector<ARC> child; // child arcs
+	vector<ARC> parent; // parent nodes/arcs
+	const int delivery_cost = -100; // "reward" for delivering to a parent node
+	NetgenRandom rando;
+	// methods
+	long long netgen(); // try to build network; output arc count if it worked, or an error code if not
+	void save_arc(NODE, NODE, COST, CAPACITY); // append an arc to the network
+	void create_supply(NODE, CAPACITY); //create supply nodes
+	void sort_skeleton(long long); // sort skeleton chains
+	void pick_head(NetgenIndex*, NODE); // pick destination for rubbish arcs
+	void node_parents(); // transform parent nodes into transshipment nodes, and add auxiliary arcs
+public:
+	Netgen(long, long, long, long, long, long, long, long, long, long, long, long, long, long, int, long);
+	int generate(Instance&); // build the network in memory; output 0 if it worked, or an error code if not
+	int printout(string); // build the network and print it to a specified file name
+	static void error_message(int); // print error message
+};
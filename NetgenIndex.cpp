@@ -1,8 +1,16 @@
 /*
 Modified by Adam Rumpf 2017 to work in C++.
-It has been completely rewritten to drastically simplify it, at the cost of computational efficiency.
-We're just implementing it as a linked list.
+It has been completely rewritten to drastically simplify it.
 It is built just to include the functionality required by the main NETGEN script.
+
+Edit: The linked list has been replaced by a Fenwick tree (binary indexed tree) over the original range, along with a flag per integer.
+Choosing the k'th remaining integer is a descent through the tree and removal is a tree update, so both run in logarithmic time,
+and the sequence of chosen integers is exactly the same as before.
+Most lists only ever lose a handful of integers, so the tree is not built right away.  Until then we keep a sorted list of the
+removed integers and search it instead, which makes creating a list constant-time.  Once the removed list grows past the square
+root of the range, the tree is built.  An insertion into the removed list can cost up to that square root, but all of them
+together cost no more than building the tree, so a list that gets the tree still costs linear time up front and logarithmic
+time per operation, while a list that never gets it (such as the per-node lists in the skeleton loop) costs far less.
 */
 
 /*** Copyright 1989 Norbert Schlenker.  All rights reserved.
@@ -72,30 +80,65 @@ It is built just to include the functionality required by the main NETGEN script
 *** per choose_index and remove_index operation.
 ***/
 
+#include <algorithm>
 #include "NetgenIndex.h"
 using namespace std;
 
 NetgenIndex::NetgenIndex()
 {
-	index_list = list<int>();
-	pseudo_size = 0;
+	make_index_list(1, 0);
 }
 
 NetgenIndex::NetgenIndex(int from, int to)
 {
-	index_list = list<int>();
-	for (int i = from; i <= to; i++)
-		index_list.push_back(i);
-	pseudo_size = to - from + 1;
+	make_index_list(from, to);
 }
 
 /*** Make a new index list with a specified range. */
 void NetgenIndex::make_index_list(int from, int to)
 {
-	index_list.clear();
-	for (int i = from; i <= to; i++)
-		index_list.push_back(i);
+	first = from;
+	range = (to >= from ? to - from + 1 : 0);
+	count = range;
 	pseudo_size = to - from + 1;
+	removed.clear();
+	tree_built = false;
+	tree.clear();
+	present.clear();
+}
+
+/*** Switch from the removed list to the tree, once the removed list has grown
+*** long enough that searching and inserting into it is no longer cheap.
+***/
+void NetgenIndex::build_tree()
+{
+	present.assign(range, 1);
+	for (int r : removed)
+		present[r - first] = 0;
+	removed.clear();
+
+	// Fill in the tree in linear time by passing each entry's count up to its parent
+	tree.assign(range + 1, 0);
+	for (int i = 1; i <= range; i++)
+	{
+		tree[i] += present[i - 1];
+		int up = i + (i & -i);
+		if (up <= range)
+			tree[up] += tree[i];
+	}
+
+	top_bit = 1;
+	while (2 * top_bit <= range)
+		top_bit *= 2;
+	tree_built = true;
+}
+
+/*** Clear an integer's flag and take it out of the tree counts. */
+void NetgenIndex::tree_remove(int pos)
+{
+	present[pos] = 0;
+	for (int i = pos + 1; i <= range; i += i & -i)
+		tree[i]--;
 }
 
 /*** Choose the integer at a certain position in an index list.  The
@@ -104,17 +147,49 @@ void NetgenIndex::make_index_list(int from, int to)
 ***/
 int NetgenIndex::choose_index(unsigned int position)
 {
-	if (position < 1 || position > index_list.size())
+	if (position < 1 || position > (unsigned int)count)
 		return 0;
+
+	int chosen;
+	if (tree_built == false)
+	{
+		// Find the number of removed integers below the chosen one, which is the first removed integer with at least "position" remaining integers below it
+		int lo = 0;
+		int hi = removed.size();
+		while (lo < hi)
+		{
+			int mid = (lo + hi) / 2;
+			if (removed[mid] - first - mid >= (int)position)
+				hi = mid;
+			else
+				lo = mid + 1;
+		}
+		chosen = first + position - 1 + lo;
+		removed.insert(removed.begin() + lo, chosen);
+		if ((long long)removed.size() * (long long)removed.size() > range)
+			build_tree();
+	}
 	else
 	{
-		list<int>::iterator it = index_list.begin();
-		advance(it, position - 1);
-		int chosen = *it;
-		index_list.erase(it);
-		pseudo_size--;
-		return chosen;
+		// Descend the tree to find the last tree position with fewer than "position" remaining integers at or before it
+		int pos = 0;
+		int remaining = position;
+		for (int step = top_bit; step > 0; step /= 2)
+		{
+			if (pos + step <= range && tree[pos + step] < remaining)
+			{
+				pos += step;
+				remaining -= tree[pos];
+			}
+		}
+
+		// The chosen integer sits just after that position
+		chosen = first + pos;
+		tree_remove(pos);
 	}
+	count--;
+	pseudo_size--;
+	return chosen;
 }
 
 /*** Remove a particular integer from an index list.  If the integer
@@ -125,21 +200,33 @@ void NetgenIndex::remove_index(int index)
 {
 	pseudo_size--;
 
-	// Search for the specified element
-	list<int>::iterator it = index_list.begin();
-	while (*it != index && it != index_list.end())
-		it++;
-
-	// If we've found the searched element, remove it
-	if (*it == index)
-		index_list.remove(index);
+	// If the specified element is still in the list, remove it
+	int pos = index - first;
+	if (pos < 0 || pos >= range)
+		return;
+	if (tree_built == false)
+	{
+		vector<int>::iterator it = lower_bound(removed.begin(), removed.end(), index);
+		if (it == removed.end() || *it != index)
+		{
+			removed.insert(it, index);
+			count--;
+			if ((long long)removed.size() * (long long)removed.size() > range)
+				build_tree();
+		}
+	}
+	else if (present[pos] == 1)
+	{
+		tree_remove(pos);
+		count--;
+	}
 }
 
 /*** Return actual number of remaining entries in the index list.
 ***/
 int NetgenIndex::index_size()
 {
-	return index_list.size();
+	return count;
 }
 
 int NetgenIndex::get_pseudo_size()
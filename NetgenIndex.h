@@ -1,12 +1,21 @@
 #pragma once
-#include <list>
+#include <vector>
 using namespace std;
 
 class NetgenIndex
 {
 private:
-	list<int> index_list;
+	int first; // smallest integer the list was made with
+	int range; // number of integers the list was made with
+	int count; // number of integers remaining in the list
+	int top_bit; // largest power of 2 no greater than range, for searching the tree
+	vector<int> removed; // sorted list of removed integers, used until the tree is built
+	bool tree_built; // whether the tree and flags below are in use
+	vector<int> tree; // Fenwick tree of remaining integers, tree[i] counting the positions (i - (i & -i), i]
+	vector<char> present; // whether each integer is still in the list
 	int pseudo_size; // a conservative approximation of the list's size to avoid trying to search an empty list
+	void build_tree();
+	void tree_remove(int);
 public:
 	NetgenIndex();
 	NetgenIndex(int, int);
@@ -13,9 +13,15 @@ Modified by Adam Rumpf 2017 to work in C++.
 *** The generator is the congruential:  i = 7**5 * i mod (2^31-1).
 ***/
 
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
 #include "NetgenRandom.h"
 using namespace std;
 
+// Number of sequence positions computed side by side by the bulk fill methods.  This is fixed regardless of instruction set, so every build produces the same values.
+#define FILL_LANES 8
+
 /*** set_random - initialize constants and seed */
 
 NetgenRandom::NetgenRandom()
@@ -58,4 +64,193 @@ long NetgenRandom::random(long a, long b)
 long NetgenRandom::get_seed()
 {
 	return saved_seed;
-}
\ No newline at end of file
+}
+
+
+/*** skip - jump ahead in the sequence.  Each call to random() multiplies
+*** the seed by 7**5 modulo 2^31-1, so n calls multiply it by 7**(5n),
+*** which we get by repeated squaring in O(log n) steps.  The seed must
+*** already be reduced (0 <= seed < 2^31-1), as random() assumes.
+***/
+
+void NetgenRandom::skip(unsigned long long n)
+{
+	saved_seed = (long)((multiplier_power(n) * (unsigned long long)saved_seed) % MODULUS);
+}
+
+unsigned long long NetgenRandom::multiplier_power(unsigned long long n) const
+{
+	unsigned long long factor = 1;
+	unsigned long long power = MULTIPLIER;
+	n %= MODULUS - 1; // the multiplier's order divides 2^31-2
+	while (n > 0)
+	{
+		if (n & 1)
+			factor = (factor * power) % MODULUS;
+		power = (power * power) % MODULUS;
+		n >>= 1;
+	}
+	return factor;
+}
+
+
+/*** substream - split the sequence into consecutive slices of a fixed
+*** length, and return a generator at the start of one of them.  Slices
+*** with different numbers never overlap as long as number * length stays
+*** below the period (2^31-2), so each can be drawn from independently and
+*** in any order while reproducing the same values as one serial stream.
+***/
+
+NetgenRandom NetgenRandom::substream(unsigned long long number, unsigned long long length) const
+{
+	NetgenRandom sub(saved_seed);
+	sub.skip(number * length);
+	return sub;
+}
+
+
+/*** Bulk generation.  The scalar generator can't go any faster than one
+*** dependent multiply-and-reduce per value, so instead we keep FILL_LANES
+*** seeds that are FILL_LANES positions apart, and step all of them at
+*** once by 16807**FILL_LANES.  Products of two 31-bit numbers fit in 62
+*** bits, and since the modulus is 2^31-1 a product p reduces as
+*** (p & (2^31-1)) + (p >> 31), minus one more modulus if that is too big.
+*** The lane arithmetic uses AVX-512 or AVX2 when the compiler targets
+*** them, and plain 64-bit integers otherwise; all three give the same
+*** seeds as random(), just computed in a different order.
+***/
+
+// Steps every lane seed by the given factor, writing the new seeds both back into the lanes and into "out".
+static inline void step_lanes(unsigned long long* lanes, unsigned long long factor, unsigned long long* out)
+{
+	const unsigned long long modulus = 2147483647;
+#if defined(__AVX512F__)
+	__m512i x = _mm512_loadu_si512((const void*)lanes);
+	__m512i p = _mm512_mul_epu32(x, _mm512_set1_epi64((long long)factor));
+	__m512i m = _mm512_set1_epi64((long long)modulus);
+	__m512i r = _mm512_add_epi64(_mm512_and_si512(p, m), _mm512_srli_epi64(p, 31));
+	r = _mm512_mask_sub_epi64(r, _mm512_cmpge_epu64_mask(r, m), r, m);
+	_mm512_storeu_si512((void*)lanes, r);
+	_mm512_storeu_si512((void*)out, r);
+#elif defined(__AVX2__)
+	__m256i f = _mm256_set1_epi64x((long long)factor);
+	__m256i m = _mm256_set1_epi64x((long long)modulus);
+	__m256i m_less = _mm256_set1_epi64x((long long)modulus - 1);
+	for (int half = 0; half < FILL_LANES; half += 4)
+	{
+		__m256i x = _mm256_loadu_si256((const __m256i*)(lanes + half));
+		__m256i p = _mm256_mul_epu32(x, f);
+		__m256i r = _mm256_add_epi64(_mm256_and_si256(p, m), _mm256_srli_epi64(p, 31));
+		r = _mm256_sub_epi64(r, _mm256_and_si256(m, _mm256_cmpgt_epi64(r, m_less))); // values stay below 2^33, so a signed compare is fine
+		_mm256_storeu_si256((__m256i*)(lanes + half), r);
+		_mm256_storeu_si256((__m256i*)(out + half), r);
+	}
+#else
+	for (int j = 0; j < FILL_LANES; j++)
+	{
+		unsigned long long p = lanes[j] * factor;
+		unsigned long long r = (p & modulus) + (p >> 31);
+		if (r >= modulus)
+			r -= modulus;
+		lanes[j] = r;
+		out[j] = r;
+	}
+#endif
+}
+
+// Computes seed % range without a division.  The seed and range are both below 2^31, so the floating-point quotient is off by at most one and a single correction makes it exact.
+static inline long reduce(unsigned long long seed, unsigned long long range, double inverse)
+{
+	long long remainder = (long long)seed - (long long)((double)seed * inverse) * (long long)range;
+	if (remainder < 0)
+		remainder += range;
+	else if (remainder >= (long long)range)
+		remainder -= range;
+	return (long)remainder;
+}
+
+/*** fill - store the next "count" values of random(a, b) in "out", and
+*** leave the generator where those calls would have left it.
+***/
+
+void NetgenRandom::fill(long a, long b, long* out, size_t count)
+{
+	// Short runs aren't worth setting up the lanes for
+	if (count < 2 * FILL_LANES)
+	{
+		for (size_t i = 0; i < count; i++)
+			out[i] = random(a, b);
+		return;
+	}
+
+	// Lane j holds the seed for sequence position j (counting from 0 for the next value), so we start each lane one step before its first position
+	unsigned long long lanes[FILL_LANES];
+	unsigned long long seeds[FILL_LANES];
+	unsigned long long jump = multiplier_power(FILL_LANES);
+	lanes[0] = saved_seed;
+	for (int j = 1; j < FILL_LANES; j++)
+		lanes[j] = (lanes[j - 1] * MULTIPLIER) % MODULUS;
+	unsigned long long range = (b > a ? b - a + 1 : 0);
+	double inverse = (range > 0 ? 1.0 / range : 0);
+
+	// Each step produces the seeds for FILL_LANES consecutive positions
+	size_t i = 0;
+	unsigned long long factor = MULTIPLIER; // the first step moves each lane onto its own position
+	while (i < count)
+	{
+		step_lanes(lanes, factor, seeds);
+		factor = jump;
+		size_t block = (count - i < FILL_LANES ? count - i : FILL_LANES);
+		for (size_t j = 0; j < block; j++)
+			out[i + j] = (range > 0 ? a + reduce(seeds[j], range, inverse) : b);
+		i += block;
+		if (i == count)
+			saved_seed = (long)seeds[block - 1];
+	}
+}
+
+void NetgenRandom::fill(long a, long b, vector<long> & out)
+{
+	fill(a, b, out.data(), out.size());
+}
+
+/*** fill_streams - store "count" values in [a, b] in "out", using the
+*** same stretch of the sequence as fill() (and leaving the generator at
+*** the same place), but handing it out in a different order: the stretch
+*** is cut into FILL_LANES blocks, one per lane, and the output takes one
+*** value from each block in turn.  When count isn't a multiple of
+*** FILL_LANES, the first count % FILL_LANES blocks are one value longer
+*** than the rest, so the blocks cover exactly count positions.  Each lane
+*** then only ever steps by 16807, and values are scaled into [a, b] with
+*** a multiply and shift instead of a division, which makes this the
+*** cheaper of the two.  The values are reproducible, but are not the
+*** ones random() would give.
+***/
+
+void NetgenRandom::fill_streams(long a, long b, long* out, size_t count)
+{
+	if (count == 0)
+		return;
+	size_t rows = (count + FILL_LANES - 1) / FILL_LANES; // values in the longest blocks
+	size_t long_lanes = count - (rows - 1) * FILL_LANES; // lanes whose blocks have that many values (the rest have one fewer)
+	unsigned long long lanes[FILL_LANES];
+	unsigned long long seeds[FILL_LANES];
+	unsigned long long long_jump = multiplier_power(rows);
+	unsigned long long short_jump = multiplier_power(rows - 1);
+	lanes[0] = saved_seed;
+	for (size_t j = 1; j < FILL_LANES; j++)
+		lanes[j] = (lanes[j - 1] * (j - 1 < long_lanes ? long_jump : short_jump)) % MODULUS;
+	unsigned long long range = (b > a ? b - a + 1 : 0);
+
+	for (size_t row = 0; row < rows; row++)
+	{
+		step_lanes(lanes, MULTIPLIER, seeds);
+		for (int j = 0; j < FILL_LANES; j++)
+		{
+			size_t i = row * FILL_LANES + j;
+			if (i < count) // only the long blocks reach the last row
+				out[i] = (range > 0 && seeds[j] > 0 ? a + (long)(((seeds[j] - 1) * range) >> 31) : b); // seeds run from 1 to 2^31-2, so this stays below b + 1
+		}
+	}
+	skip(count);
+}
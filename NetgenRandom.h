@@ -1,4 +1,6 @@
 #pragma once
+#include <cstddef>
+#include <vector>
 using namespace std;
 
 class NetgenRandom
@@ -7,10 +9,17 @@ private:
 	const long MULTIPLIER = 16807;
 	const long MODULUS = 2147483647;
 	long saved_seed;
+	unsigned long long multiplier_power(unsigned long long) const; // 16807^n mod 2^31-1
 public:
 	NetgenRandom();
 	NetgenRandom(long);
 	void set_random(long);
 	long random(long, long);
 	long get_seed();
-};
\ No newline at end of file
+	void skip(unsigned long long); // advance the generator as if random() had been called the specified number of times
+	NetgenRandom substream(unsigned long long, unsigned long long) const; // copy positioned at the start of a numbered slice of a given length
+	void fill(long, long, long*, size_t); // the same values as that many calls to random(), computed several at a time
+	void fill(long, long, vector<long>&);
+	void fill_streams(long, long, long*, size_t); // faster fill from interleaved streams, which does not reproduce the random() sequence
+
+};
@@ -1,116 +1,190 @@
 /*
-Reads in a specified .min file generated by NETGEN, as well as parent/child flow values, and applies a randomized rounding rule to obtain a feasible solution. Feeds the problem to CPLEX and writes the results to a specified file. We expect exactly six arguments: the name of the .min file, the name of the main output file, the name of the parent flow file, the name of the child flow file, a random seed, and a number specifying which randomized rounding scheme to use (1 for RRC, 2 for RRP, 3 for RRF).
+Reads in a specified .min file generated by NETGEN, as well as parent/child flow values, and applies a randomized rounding rule to obtain a feasible solution. Feeds the problem to CPLEX and writes the results to a specified file. We expect exactly six arguments: the name of the .min file, the name of the main output file, the name of the parent flow file, the name of the child flow file, a random seed, and a number specifying which randomized rounding scheme to use (1 for RRC, 2 for RRP, 3 for RRF). Three more arguments are optional: the probability bound, a number of attempts, and an LP basis file (see LpBasis.h) to warm-start CPLEX from.  Given more than one attempt, the seed instead starts a stream of attempt seeds, and roundings are retried on the same model until one is feasible; the output file then also lists the number of tries and the successful seed.
+
+The mode may also be a comma-separated list of rules, each a mode with an optional bound after a colon (for example 1:0,1:0.01,2:0.05,3), to run several rules against one loaded instance and one model.  The output file then has a line for each rule with its mode, bound, objective, time, and tries (the objective and time are -999 for rules that weren't solved).
+
+The input may also be a binary instance file (see BinFile.h), which is recognized by its first few bytes.
+
+When compiled with MCNFLI_LIB defined, the main method is left out and the solver is instead called in-process through solve_rr() (see RrSolver.h).
 */
 
 #include <iostream>
 #include <string>
 #include <fstream>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include <thread>
+#include <atomic>
 #include "ilcplex\cplex.h"
 #include "ilcplex\ilocplex.h"
+#include "BinFile.h"
 #include "NetgenRandom.h"
+#include "MinCostFlow.h"
+#include "MaxFlow.h"
+#include "ModelBuilder.h"
+#include "LpBasis.h"
+#include "RrSolver.h"
+#include "Timer.h"
 using namespace std;
 
-// Global variables and structures
-string input_name;
-string output_name;
-string parent_out_name;
-string child_out_name;
-long seed;
-int mode;
-double bound;
-long NODES;
-long SOURCES;
-long SINKS;
-long DENSITY;
-long DENSITY_INIT; // initial density, before artificial arcs are added
-int PARENT;
-long INTER;
-#define MAXNODES 5000
-#define MAXARCS 60000
-long b[MAXNODES];
-long u[MAXARCS];
-long c[MAXARCS];
-unsigned long tail[MAXARCS];
-long head[MAXARCS]; // negative head means we're ignoring it
-unsigned long parent[MAXARCS];
-unsigned long child[MAXARCS];
-double parent_flow[MAXARCS];
-double child_flow[MAXARCS];
-const double delivery_cost = -1; // unit delivery "reward" for relaxed sinks
-double sol_objective;
-double sol_time;
-
 // Prototypes
-int readin();
-int read_parent();
-int read_child();
-int to_cplex();
+static int read_flow(string, long, vector<double>&);
 
+#ifndef MCNFLI_LIB
 int main(int argc, char* argv[])
 {
-	if (argc != 7 && argc != 8)
+	if (argc < 7 || argc > 10)
 	{
-		cout << "Expecting the following 6 (7) arguments: [input file] [output file] [parent flow file] [child flow file] [seed] [mode] ([bound])\n";
+		cout << "Expecting the following 6 (9) arguments: [input file] [output file] [parent flow file] [child flow file] [seed] [mode] ([bound] [attempts] [basis file])\n";
 		return -1;
 	}
 	else
 	{
-		// Save parameters as global variables
-		input_name = argv[1];
-		output_name = argv[2];
-		parent_out_name = argv[3];
-		child_out_name = argv[4];
-		seed = stoi(argv[5]);
-		mode = stoi(argv[6]);
+		// Save parameters
+		string input_name = argv[1];
+		string output_name = argv[2];
+		string parent_out_name = argv[3];
+		string child_out_name = argv[4];
+		long seed = stoi(argv[5]);
+		string mode_list = argv[6];
+		double bound;
 		if (argc == 7)
 			bound = 0;
 		else
 			bound = stod(argv[7]);
+		int attempts = 1;
+		if (argc >= 9)
+			attempts = stoi(argv[8]);
+
+		// The mode may be a comma-separated list of rules, each a mode with an optional ":bound" (the bound argument otherwise)
+		vector<RrVariant> variants;
+		size_t pos = 0;
+		while (pos <= mode_list.size())
+		{
+			size_t end = mode_list.find(',', pos);
+			if (end == string::npos)
+				end = mode_list.size();
+			string rule = mode_list.substr(pos, end - pos);
+			size_t colon = rule.find(':');
+			RrVariant variant;
+			variant.mode = stoi(rule.substr(0, colon));
+			variant.bound = (colon == string::npos ? bound : stod(rule.substr(colon + 1)));
+			variants.push_back(variant);
+			pos = end + 1;
+		}
+		int mode = variants[0].mode;
+		bool need_child = false, need_parent = false;
 
 		// Check variable validity
-		if (seed <= 0 || mode < 1 || mode > 3)
+		for (const RrVariant & variant : variants)
 		{
-			cout << "Mode must be 1, 2, or 3\n";
-			return -1;
+			if (seed <= 0 || variant.mode < 1 || variant.mode > 3)
+			{
+				cout << "Mode must be 1, 2, or 3\n";
+				return -1;
+			}
+			if (variant.bound < 0 || variant.bound >= 0.5)
+			{
+				cout << "Bound must come from [0,0.5)\n";
+				return -1;
+			}
+			need_child = need_child || variant.mode == 1;
+			need_parent = need_parent || variant.mode == 2;
 		}
-		if (bound < 0 || bound >= 0.5)
+		bound = variants[0].bound;
+		if (attempts < 1)
 		{
-			cout << "Bound must come from [0,0.5)\n";
+			cout << "Number of attempts must be positive\n";
 			return -1;
 		}
 
+		Instance inst;
+		Result res;
+		Result lp; // LP flows and basis, if given
+		vector<double> parent_flow;
+		vector<double> child_flow;
+
 		// Try to read in the problem
-		if (readin() == 0)
+		if (read_instance(input_name, inst) == 0)
 		{
-			if (mode == 1)
+			if (need_child)
 			{
-				if (read_child() != 0)
+				if (read_flow(child_out_name, inst.INTER, child_flow) != 0)
 				{
 					cout << "RR solver failed to read in child flow file " << child_out_name << '\n';
 					return -1;
 				}
 			}
 
-			if (mode == 2)
+			if (need_parent)
 			{
-				if (read_parent() != 0)
+				if (read_flow(parent_out_name, inst.INTER, parent_flow) != 0)
 				{
 					cout << "RR solver failed to read in parent flow file " << parent_out_name << '\n';
 					return -1;
 				}
 			}
 
+			if (argc == 10)
+			{
+				if (read_basis(argv[9], inst, lp) != 0)
+				{
+					cout << "RR solver failed to read in basis file " << argv[9] << '\n';
+					return -1;
+				}
+			}
+
 			// Try to solve the problem
-			if (to_cplex() == 0)
+			int output;
+			const Result * lp_start = (argc == 10 ? &lp : nullptr);
+			int engine = (argc == 10 ? RR_CPLEX : RR_NATIVE); // the basis is for CPLEX's simplex
+			if (variants.size() > 1)
+			{
+				// Several rules on one model, with a line of results for each: mode, bound, objective, time, and tries
+				vector<Result> variant_res;
+				solve_rr_variants(inst, parent_flow, child_flow, seed, variants, attempts, variant_res, 0, engine, lp_start);
+				PhaseTimer timer(PHASE_WRITE);
+				ofstream outfile;
+				outfile.open(output_name);
+				if (outfile.is_open())
+				{
+					outfile << fixed;
+					for (size_t k = 0; k < variants.size(); k++)
+						outfile << variants[k].mode << '\t' << variants[k].bound << '\t' << variant_res[k].objective << '\t' << variant_res[k].time << '\t' << variant_res[k].tries << '\n';
+					outfile.close();
+					timer.stop();
+					if (timing_enabled)
+						thread_phase_times().print(cout);
+					return 0;
+				}
+				else
+				{
+					cout << "Output file " << output_name << " failed to open.\n";
+					return -1;
+				}
+			}
+			if (attempts == 1)
+				output = solve_rr(inst, parent_flow, child_flow, seed, mode, bound, res, 0, engine, lp_start);
+			else
+				output = solve_rr_attempts(inst, parent_flow, child_flow, seed, mode, bound, attempts, res, 0, engine, lp_start);
+			if (output == 0)
 			{
 				// If the solution is found, output the results to a file
+				PhaseTimer timer(PHASE_WRITE);
 				ofstream outfile;
 				outfile.open(output_name);
 				if (outfile.is_open())
 				{
 					outfile << fixed;
-					outfile << sol_objective << '\n' << sol_time;
+					outfile << res.objective << '\n' << res.time;
+					if (attempts > 1)
+						outfile << '\n' << res.tries << '\n' << res.seed;
 					outfile.close();
+					timer.stop();
+					if (timing_enabled)
+						thread_phase_times().print(cout);
 				}
 				else
 				{
@@ -131,237 +205,483 @@ int main(int argc, char* argv[])
 		}
 	}
 }
+#endif
 
-// Reads specified input file.  Returns 0 if successful.
-int readin()
+/*
+CPLEX version of the flow engine: the arc variables, network constraints, and objective of the RR model, built and extracted once.  Bound changes are collected and handed to CPLEX together just before each solve.
+*/
+class CplexFlow : public FlowEngine
 {
-	int phase = 0; // 0 for objective, 1 for sources, 2 for sinks, 3 for arcs, 4 for interdependencies
-	ifstream infile;
-	infile.open(input_name);
-	if (infile.is_open())
+private:
+	IloEnv env; // environment
+	IloModel model; // model
+	IloNumVarArray x; // arc flows
+	IloCplex cplex; // Cplex object
+	IloRangeArray con1; // node balance rows
+	vector<long> changed; // arcs with new bounds since the last solve
+	vector<long> lb, ub; // current bounds, indexed by arc
+	vector<char> pending; // whether each arc is in the changed list
+	const Result * start; // LP result to warm-start from, if any
+	void set_start_basis();
+public:
+	CplexFlow(const Instance&, const NetworkMatrix&, int);
+	~CplexFlow();
+	void set_bounds(long, long, long);
+	int solve(double&);
+	void get_flow(vector<long>&) const;
+	void warm_start(const Result&);
+};
+
+// Builds and extracts the network model from the instance's incidence matrix.
+CplexFlow::CplexFlow(const Instance & inst, const NetworkMatrix & matrix, int threads) : model(env), cplex(env)
+{
+	IloObjective obj;
+	build_network(env, model, inst, matrix, x, con1, obj);
+
+	lb.assign(inst.DENSITY, 0);
+	ub.assign(inst.u.begin(), inst.u.end());
+	pending.assign(inst.DENSITY, 0);
+	start = nullptr;
+
+	// Extraction
+	if (threads > 0)
+		cplex.setParam(IloCplex::Param::Threads, threads); // leave cores for any other trials running alongside this one
+	cplex.extract(model);
+}
+
+CplexFlow::~CplexFlow()
+{
+	cplex.clear();
+	env.end();
+}
+
+void CplexFlow::set_bounds(long arc, long lower, long upper)
+{
+	lb[arc] = lower;
+	ub[arc] = upper;
+	if (pending[arc] == 0)
 	{
-		// Read in the .min file line-by-line, filling the vectors as we go
-		int counter = 0; // counter for node or arc number
-		while (infile.eof() == false)
-		{
-			string line, piece; // current line and piece of line
-			getline(infile, line); // get whole line
-			stringstream stream(line); // stream of line
-			int id; // numbers read from line
+		pending[arc] = 1;
+		changed.push_back(arc);
+	}
+}
 
-			// Categorize type of line based on the first character
-			switch (line[0])
-			{
-			// Ignore comments (c)
-			case 'p': // min NODES DENSITY INTER PARENT
-				getline(stream, piece, ' '); // 'p'
-				getline(stream, piece, ' '); // "min"
-				getline(stream, piece, ' '); // NODES
-				NODES = stoi(piece);
-				getline(stream, piece, ' '); // DENSITY
-				DENSITY_INIT = stoi(piece);
-				DENSITY = DENSITY_INIT;
-				getline(stream, piece, ' '); // INTER
-				INTER = stoi(piece);
-				getline(stream, piece, ' '); // PARENTS
-				if (piece[0] == 'a')
-					PARENT = 1;
-				else
-					PARENT = 0;
-				phase = 1;
-				break;
-			case 'n': // n ID FLOW
-				getline(stream, piece, ' '); // 'n'
-				getline(stream, piece, ' '); // ID
-				id = stoi(piece);
-				getline(stream, piece, ' '); // FLOW
-				b[id - 1] = stoi(piece);
-				if (b[id - 1] < 0 && phase == 1)
-				{
-					// we've just hit the first sink
-					phase = 2;
-					SOURCES = counter;
-					counter = 0;
-				}
-				counter++;
-				break;
-			case 'a': // a SRC DST LOW CAP COST
-				if (phase == 1)
-				{
-					// there were no sinks
-					phase = 2;
-					SOURCES = counter;
-					counter = 0;
-				}
-				if (phase == 2)
-				{
-					// we've just hit the first arc
-					phase = 3;
-					SINKS = counter;
-					counter = 0;
-				}
-				getline(stream, piece, ' '); // 'a'
-				getline(stream, piece, ' '); // SRC
-				tail[counter] = stoi(piece) - 1;
-				getline(stream, piece, ' '); // DST
-				head[counter] = stoi(piece) - 1;
-				getline(stream, piece, ' '); // LOW
-				getline(stream, piece, ' '); // CAP
-				u[counter] = stoi(piece);
-				getline(stream, piece, ' '); // COST
-				c[counter] = stoi(piece);
-				counter++;
-				break;
-			case 'i': // i parent child
-				if (phase == 3)
-				{
-					// we've just hit the first interdependency
-					phase = 4;
-					counter = 0;
-				}
-				getline(stream, piece, ' '); // 'i'
-				getline(stream, piece, ' '); // parent
-				parent[counter] = stoi(piece) - 1;
-				getline(stream, piece, ' '); // child
-				child[counter] = stoi(piece) - 1;
-				counter++;
-				break;
-			}
+// Applies the collected bound changes in one call and solves.  Returns 0 if a solution is found.
+int CplexFlow::solve(double & objective)
+{
+	if (changed.empty() == false)
+	{
+		IloNumVarArray changed_x(env);
+		IloNumArray lbs(env, changed.size());
+		IloNumArray ubs(env, changed.size());
+		for (size_t k = 0; k < changed.size(); k++)
+		{
+			changed_x.add(x[changed[k]]);
+			lbs[k] = lb[changed[k]];
+			ubs[k] = ub[changed[k]];
+			pending[changed[k]] = 0;
 		}
+		changed_x.setBounds(lbs, ubs);
+		changed_x.end();
+		lbs.end();
+		ubs.end();
+		changed.clear();
+	}
+	if (start != nullptr)
+		set_start_basis();
 
-		infile.close();
+	IloBool solved = cplex.solve();
+	if (solved == IloTrue)
+	{
+		objective = cplex.getObjValue();
 		return 0;
 	}
 	else
+	{
+		objective = -999;
 		return -1;
+	}
 }
 
-// Builds and exports the model defined by the input file.  Outputs 0 if a solution is found.
-int to_cplex()
+// Reads the arc flows of the last solve.  Bounds and supplies are integers, so the optimal vertex is integral and the values are only rounded off.
+void CplexFlow::get_flow(vector<long> & flow) const
 {
-	// Prepare CPLEX
-	IloEnv env; // environment
-	IloModel model(env); // model
+	IloNumArray values(env);
+	cplex.getValues(values, x);
+	flow.resize(x.getSize());
+	for (long i = 0; i < x.getSize(); i++)
+		flow[i] = lround(values[i]);
+	values.end();
+}
 
-	// Variables and bounds
-	IloNumVarArray x(env);
-	for (int i = 0; i < DENSITY; i++)
-		x.add(IloNumVar(env, 0, u[i], ILOFLOAT));
+// Starts later solves from an LP result's basis, using the dual simplex, since a rounding only changes bounds.
+void CplexFlow::warm_start(const Result & lp)
+{
+	if ((long)lp.arc_status.size() != x.getSize() || (long)lp.node_status.size() != con1.getSize())
+		return; // no basis was saved
+	start = &lp;
+	cplex.setParam(IloCplex::Param::RootAlgorithm, IloCplex::Dual);
+}
 
-	// Network constraints
-	IloRangeArray con1(env);
-	for (int i = 0; i < NODES; i++)
+/*
+Hands the LP basis to CPLEX, adjusted to the current bounds.  Arcs fixed by the rounding become nonbasic at their fixed value.  The LP had one basic variable for each interdependency row as well, and those rows aren't in this model, so basic arcs are made nonbasic (starting with the ones the LP left closest to a bound) until the count matches the number of rows, or row slacks are made basic if there are too few.  CPLEX repairs any singularity that is left.
+*/
+void CplexFlow::set_start_basis()
+{
+	long arcs = x.getSize();
+	long rows = con1.getSize();
+	IloCplex::BasisStatusArray arc_status(env, arcs), node_status(env, rows);
+	long basics = 0;
+	for (long i = 0; i < arcs; i++)
 	{
-		if (PARENT == 0 && i < SOURCES)
-			con1.add(IloRange(env, 0, b[i])); // relax source supply values if we're using nodes as parents
-		else
-			con1.add(IloRange(env, b[i], b[i])); // otherwise, it's an equality constraint
+		int status = start->arc_status[i];
+		if (lb[i] == ub[i])
+			status = (ub[i] == 0 ? BASIS_LOWER : BASIS_UPPER);
+		arc_status[i] = (IloCplex::BasisStatus)status;
+		if (status == BASIS_BASIC)
+			basics++;
 	}
-	for (int i = 0; i < DENSITY; i++)
+	for (long i = 0; i < rows; i++)
 	{
-		con1[tail[i]].setLinearCoef(x[i], 1); // tail coefficient
-		if (head[i] >= 0)
-			con1[head[i]].setLinearCoef(x[i], -1); // head coefficient (only applies to non-auxiliary arcs)
+		node_status[i] = (IloCplex::BasisStatus)start->node_status[i];
+		if (start->node_status[i] == BASIS_BASIC)
+			basics++;
 	}
-	model.add(con1);
 
-	// Interdependencies
-	NetgenRandom * rand_num = new NetgenRandom(seed);
-	IloRangeArray con2(env);
-	for (int i = 0; i < INTER; i++)
+	// Too many basic arcs: demote those whose LP flow is nearest a bound
+	if (basics > rows)
+	{
+		vector<pair<double, long> > slack; // distance to nearest bound, arc
+		for (long i = 0; i < arcs; i++)
+		{
+			if (arc_status[i] == IloCplex::Basic)
+				slack.push_back(make_pair(min(start->flow[i] - lb[i], ub[i] - start->flow[i]), i));
+		}
+		sort(slack.begin(), slack.end());
+		for (size_t k = 0; k < slack.size() && basics > rows; k++)
+		{
+			long i = slack[k].second;
+			arc_status[i] = (start->flow[i] - lb[i] <= ub[i] - start->flow[i] ? IloCplex::AtLower : IloCplex::AtUpper);
+			basics--;
+		}
+	}
+
+	// Too few: make row slacks basic
+	for (long i = 0; i < rows && basics < rows; i++)
+	{
+		if (node_status[i] != IloCplex::Basic)
+		{
+			node_status[i] = IloCplex::Basic;
+			basics++;
+		}
+	}
+
+	cplex.setBasisStatuses(arc_status, x, node_status, con1);
+	arc_status.end();
+	node_status.end();
+}
+
+/*
+The RR model: a flow engine holding the network, a feasibility oracle (see MaxFlow.h) that screens out roundings with no feasible flow before the engine solves them, plus each interdependency's rounding threshold.  It's built once so that any number of rounding attempts can be solved with it.  An attempt only changes the bounds of the parent and child arcs: using a child fixes its parent's flow at capacity, and not using it fixes the child's flow at 0.
+*/
+class RrModel
+{
+private:
+	const Instance & inst;
+	const vector<double> & parent_flow;
+	const vector<double> & child_flow;
+	FlowEngine * engine;
+	FeasibilityOracle * oracle; // rejects roundings with no feasible flow before the engine sees them
+	vector<double> threshold; // probability of choosing to use each child
+	vector<long> touched; // arcs whose bounds the rounding can change
+	vector<long> lb, ub; // working bounds, indexed by arc
+public:
+	RrModel(const Instance&, const vector<double>&, const vector<double>&, int, double, int, int, const Result*, const NetworkMatrix*);
+	~RrModel();
+	void set_rounding(int, double); // switch to another rounding rule (mode and bound)
+	int attempt(long, double&, double&); // solve one rounding with a given seed; output 0 if feasible, filling objective and time
+	void get_flow(vector<long> & flow) const { engine->get_flow(flow); } // arc flows of the last feasible attempt
+};
+
+// Builds the chosen engine's model (warm-started from the LP if given), and works out each interdependency's rounding threshold.  The CPLEX engine needs the instance's incidence matrix.
+RrModel::RrModel(const Instance & instance, const vector<double> & parent_flows, const vector<double> & child_flows, int mode, double bound, int threads, int engine_type, const Result * lp_start, const NetworkMatrix * matrix)
+	: inst(instance), parent_flow(parent_flows), child_flow(child_flows)
+{
+	if (engine_type == RR_CPLEX)
+		engine = new CplexFlow(inst, *matrix, threads);
+	else
+		engine = new NetworkSimplex(inst);
+	oracle = new FeasibilityOracle(inst);
+	if (lp_start != nullptr)
+		engine->warm_start(*lp_start);
+	set_rounding(mode, bound);
+
+	// Arcs involved in interdependencies, each listed once
+	vector<char> listed(inst.DENSITY, 0);
+	for (int i = 0; i < inst.INTER; i++)
+	{
+		for (long arc : { (long)inst.parent[i], (long)inst.child[i] })
+		{
+			if (listed[arc] == 0)
+			{
+				listed[arc] = 1;
+				touched.push_back(arc);
+			}
+		}
+	}
+	lb.assign(inst.DENSITY, 0);
+	ub.assign(inst.DENSITY, 0);
+}
+
+// Works out each interdependency's rounding threshold for a rounding rule.  The engine keeps its state, so later attempts still start from the last solve.
+void RrModel::set_rounding(int mode, double bound)
+{
+	threshold.resize(inst.INTER);
+	for (int i = 0; i < inst.INTER; i++)
 	{
-		// Roll to see whether to shut off the child or max out the parent
-		double threshold; // probability of choosing to use the child
 		switch (mode)
 		{
 			case 1: // child fullness
-				threshold = (1.0 * child_flow[i]) / u[child[i]];
+				threshold[i] = (1.0 * child_flow[i]) / inst.u[inst.child[i]];
 				break;
 			case 2: // parent fullness
-				threshold = (1.0 * parent_flow[i]) / u[parent[i]];
+				threshold[i] = (1.0 * parent_flow[i]) / inst.u[inst.parent[i]];
 				break;
 			case 3: // 50/50
-				threshold = 0.5;
+				threshold[i] = 0.5;
 				break;
 		}
 		// Tighten threshold according to bounds
-		if (threshold > 1 - bound)
-			threshold = 1 - bound;
-		if (threshold < bound)
-			threshold = bound;
-		double prob = (rand_num->random(1, 1000000) - 1) / (1.0 * 1000000);
-		if (prob < threshold)
-			con2.add(x[parent[i]] == u[parent[i]]); // using the child, so max out the parent
-		else
-			con2.add(x[child[i]] == 0); // not using the child, so zero it out
+		if (threshold[i] > 1 - bound)
+			threshold[i] = 1 - bound;
+		if (threshold[i] < bound)
+			threshold[i] = bound;
 	}
-	model.add(con2);
-	delete rand_num;
+}
 
-	// Objective
-	IloObjective obj = IloMinimize(env);
-	for (int i = 0; i < DENSITY; i++)
-		obj.setLinearCoef(x[i], c[i]); // arc cost coefficient
-	model.add(obj);
+RrModel::~RrModel()
+{
+	delete engine;
+	delete oracle;
+}
 
-	// Extraction and solution
-	IloCplex cplex(env); // Cplex object
-	cplex.extract(model);
-	IloNum start = cplex.getTime(); // starting time
-	IloBool solved = cplex.solve();
-	sol_time = cplex.getTime() - start; // stop timer
+// Rolls a rounding from the seed, applies it as bounds, and solves.  Returns 0 if a solution is found.
+int RrModel::attempt(long seed, double & objective, double & time)
+{
+	// Roll to see whether to shut off each child or max out its parent
+	PhaseTimer timer(PHASE_RR_ROUND);
+	NetgenRandom * rand_num = new NetgenRandom(seed);
+	vector<long> rolls(inst.INTER); // one roll per interdependency, drawn in bulk
+	rand_num->fill(1, 1000000, rolls);
+	delete rand_num;
+	for (long arc : touched)
+	{
+		lb[arc] = 0;
+		ub[arc] = inst.u[arc];
+	}
+	for (int i = 0; i < inst.INTER; i++)
+	{
+		double prob = (rolls[i] - 1) / (1.0 * 1000000);
+		if (prob < threshold[i])
+			lb[inst.parent[i]] = inst.u[inst.parent[i]]; // using the child, so max out the parent
+		else
+			ub[inst.child[i]] = 0; // not using the child, so zero it out
+	}
 
-	// Result output
-	if (solved == IloTrue)
-		sol_objective = cplex.getObjValue();
-	else
+	// An arc that is both maxed out and zeroed out can't be satisfied, so there's nothing to solve
+	for (long arc : touched)
 	{
-		sol_objective = -999;
-		sol_time = -999;
+		if (lb[arc] > ub[arc])
+		{
+			objective = -999;
+			time = 0;
+			return -1;
+		}
+	}
+	for (long arc : touched)
+	{
+		engine->set_bounds(arc, lb[arc], ub[arc]);
+		oracle->set_bounds(arc, lb[arc], ub[arc]);
 	}
 
-	// Finalization
-	cplex.clear();
-	env.end();
-	if (solved == IloTrue)
-		return 0;
+	// Solution, unless the oracle finds that there's none
+	chrono::steady_clock::time_point start = chrono::steady_clock::now(); // starting time
+	int output = -1;
+	timer.next(PHASE_RR_ORACLE);
+	bool feasible = oracle->feasible();
+	timer.next(PHASE_RR_SOLVE);
+	if (feasible)
+		output = engine->solve(objective);
 	else
-		return -1;
+		objective = -999;
+	timer.stop();
+	time = chrono::duration<double>(chrono::steady_clock::now() - start).count(); // stop timer
+	return output;
 }
 
-// Reads the parent flow values.
-int read_parent()
+// Solves a single rounding with a given seed.  Outputs 0 if a solution is found.
+int solve_rr(const Instance & inst, const vector<double> & parent_flow, const vector<double> & child_flow, long seed, int mode, double bound, Result & res, int threads, int engine, const Result * lp_start)
 {
-	ifstream infile;
-	infile.open(parent_out_name);
-	if (infile.is_open())
+	PhaseTimer timer(PHASE_RR_BUILD);
+	NetworkMatrix * matrix = (engine == RR_CPLEX ? new NetworkMatrix(inst) : nullptr);
+	RrModel * rr = new RrModel(inst, parent_flow, child_flow, mode, bound, threads, engine, lp_start, matrix);
+	delete matrix; // only needed while building
+	timer.stop();
+	int output = rr->attempt(seed, res.objective, res.time);
+	res.attempt_time.assign(1, res.time);
+	res.tries = 1;
+	if (output == 0)
 	{
-		string line;
-		for (int i = 0; i < INTER; i++)
+		vector<long> flow;
+		rr->get_flow(flow);
+		res.flow.assign(flow.begin(), flow.end());
+		res.seed = seed;
+	}
+	else
+		res.time = -999;
+	delete rr;
+	return output;
+}
+
+/*
+Solves roundings until one is feasible or the cutoff is reached, using every given model at once (each on its own thread if there are several).  Outputs 0 if a solution is found, with its arc flows.
+*/
+static int run_attempts(vector<RrModel*> & models, long seed, int cutoff, Result & res)
+{
+	const NetgenRandom rand_sub(seed); // random number to use as the seed for each attempt
+	vector<double> attempt_time(cutoff, 0); // solve time of each attempt, by number
+	vector<double> attempt_objective(cutoff, 0); // objective of each feasible attempt
+	vector<long> attempt_seed(cutoff, 0);
+	atomic<int> next(0); // number of the next attempt to hand out
+	atomic<int> found(cutoff); // lowest number of a feasible attempt so far (cutoff if none)
+	vector<vector<long>> flows(models.size()); // flows of each model's feasible attempt (a worker stops after its first success, so there's at most one)
+	vector<int> flow_attempt(models.size(), -1); // number of that attempt
+
+	// Each worker solves attempts on its own model, taking numbers in increasing order, and stops once every remaining number is above the lowest success.  So every attempt below the lowest success is solved, and it's the one a serial loop would stop at.
+	auto work = [&](size_t w)
+	{
+		RrModel * rr = models[w];
+		int k;
+		while ((k = next++) < found.load())
 		{
-			getline(infile, line);
-			parent_flow[i] = stod(line);
+			double objective, time;
+			attempt_seed[k] = rand_sub.substream(k, 1).random(1, 99999999); // each attempt's seed depends only on its number, so attempts need not run in order
+			int output = rr->attempt(attempt_seed[k], objective, time);
+			attempt_time[k] = time;
+			if (output == 0)
+			{
+				attempt_objective[k] = objective;
+				rr->get_flow(flows[w]);
+				flow_attempt[w] = k;
+				int best = found.load();
+				while (k < best && !found.compare_exchange_weak(best, k));
+			}
 		}
+	};
 
-		infile.close();
+	if (models.size() == 1)
+		work(0);
+	else
+	{
+		vector<thread> pool;
+		vector<PhaseTimes> times(models.size()); // each thread's phase times, handed back to this thread
+		for (size_t w = 0; w < models.size(); w++)
+			pool.emplace_back([&, w]() { work(w); times[w] = thread_phase_times(); });
+		for (thread & t : pool)
+			t.join();
+		for (const PhaseTimes & t : times)
+			thread_phase_times().add(t);
+	}
+
+	int best = found.load();
+	res.tries = (best < cutoff) ? best + 1 : cutoff;
+	res.attempt_time.assign(attempt_time.begin(), attempt_time.begin() + res.tries);
+	if (best < cutoff)
+	{
+		res.objective = attempt_objective[best];
+		res.time = attempt_time[best];
+		res.seed = attempt_seed[best];
+		for (size_t w = 0; w < models.size(); w++)
+			if (flow_attempt[w] == best)
+				res.flow.assign(flows[w].begin(), flows[w].end());
 		return 0;
 	}
+	res.objective = -999;
+	res.time = -999;
+	return -1;
+}
+
+// Builds a model for each thread that will solve attempts (building them in parallel too), splitting the CPLEX threads between them.  CPLEX models are all built from one incidence matrix, the given one if there is one.
+static void build_models(vector<RrModel*> & models, const Instance & inst, const vector<double> & parent_flow, const vector<double> & child_flow, int mode, double bound, int threads, int engine, const Result * lp_start, int parallel, const NetworkMatrix * given = nullptr)
+{
+	if (parallel < 1)
+		parallel = 1;
+	int model_threads = threads / parallel;
+	if (threads > 0 && model_threads < 1)
+		model_threads = 1;
+	models.assign(parallel, nullptr);
+	PhaseTimer timer(PHASE_RR_BUILD); // wall time, however many threads build
+	NetworkMatrix * built = (engine == RR_CPLEX && given == nullptr ? new NetworkMatrix(inst) : nullptr);
+	const NetworkMatrix * matrix = (engine == RR_CPLEX ? (given != nullptr ? given : built) : nullptr);
+	if (parallel == 1)
+		models[0] = new RrModel(inst, parent_flow, child_flow, mode, bound, threads, engine, lp_start, matrix);
 	else
-		return -1;
+	{
+		vector<thread> pool;
+		for (int w = 0; w < parallel; w++)
+			pool.emplace_back([&, w]() { models[w] = new RrModel(inst, parent_flow, child_flow, mode, bound, model_threads, engine, lp_start, matrix); });
+		for (thread & t : pool)
+			t.join();
+	}
+	delete built;
+}
+
+// Solves roundings until one is feasible or the cutoff is reached, on one model or on several models at once.  Outputs 0 if a solution is found.
+int solve_rr_attempts(const Instance & inst, const vector<double> & parent_flow, const vector<double> & child_flow, long seed, int mode, double bound, int cutoff, Result & res, int threads, int engine, const Result * lp_start, int parallel)
+{
+	vector<RrModel*> models;
+	build_models(models, inst, parent_flow, child_flow, mode, bound, threads, engine, lp_start, min(parallel, cutoff));
+	int output = run_attempts(models, seed, cutoff, res);
+	for (RrModel * rr : models)
+		delete rr;
+	return output;
 }
 
-// Reads the child flow values.
-int read_child()
+// Solves every rounding rule in turn on the same models.  Outputs the number of rules for which a solution is found.
+int solve_rr_variants(const Instance & inst, const vector<double> & parent_flow, const vector<double> & child_flow, long seed, const vector<RrVariant> & variants, int cutoff, vector<Result> & res, int threads, int engine, const Result * lp_start, int parallel, const NetworkMatrix * matrix)
 {
+	res.assign(variants.size(), Result());
+	if (variants.empty())
+		return 0;
+	vector<RrModel*> models;
+	build_models(models, inst, parent_flow, child_flow, variants[0].mode, variants[0].bound, threads, engine, lp_start, min(parallel, cutoff), matrix);
+	int solved = 0;
+	for (size_t k = 0; k < variants.size(); k++)
+	{
+		for (RrModel * rr : models)
+			rr->set_rounding(variants[k].mode, variants[k].bound);
+		if (run_attempts(models, seed, cutoff, res[k]) == 0)
+			solved++;
+	}
+	for (RrModel * rr : models)
+		delete rr;
+	return solved;
+}
+
+// Reads a parent or child flow file with one value per interdependency.  Returns 0 if successful.
+static int read_flow(string file_name, long INTER, vector<double> & flow)
+{
+	PhaseTimer timer(PHASE_PARSE);
 	ifstream infile;
-	infile.open(child_out_name);
+	infile.open(file_name);
 	if (infile.is_open())
 	{
 		string line;
+		flow.resize(INTER);
 		for (int i = 0; i < INTER; i++)
 		{
 			getline(infile, line);
-			child_flow[i] = stod(line);
+			flow[i] = stod(line);
 		}
 
 		infile.close();
@@ -369,4 +689,4 @@ int read_child()
 	}
 	else
 		return -1;
-}
\ No newline at end of file
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include "Instance.h"
+
+// A randomized rounding rule: the scheme (1 for RRC, 2 for RRP, 3 for RRF) and the bound restricting its probabilities to [bound,1-bound]
+struct RrVariant
+{
+	int mode;
+	double bound;
+};
+
+struct NetworkMatrix; // see ModelBuilder.h
+
+// engines for solving the rounded network
+#define RR_NATIVE 0 // built-in network simplex (see MinCostFlow.h)
+#define RR_CPLEX 1
+
+/*
+Applies a single randomized rounding to an instance and solves the rounded problem.  Besides the instance, we expect the LP's parent and child flow values (as written by the LP solver), a random seed, a number specifying which randomized rounding scheme to use (1 for RRC, 2 for RRP, 3 for RRF), and a bound restricting the rounding probabilities to [bound,1-bound].  An optional thread limit is passed on to CPLEX (0 lets CPLEX decide), and the last argument chooses the engine that solves the rounded network: the native network simplex by default, or CPLEX.  Both engines find the same optimal objective.  Finally, the LP result may be passed in so that the engine can warm-start from its flows and basis (the CPLEX engine then uses the dual simplex).  Returns 0 if a solution is found, filling the objective, time and arc flows of the result.
+*/
+int solve_rr(const Instance&, const vector<double>&, const vector<double>&, long, int, double, Result&, int = 0, int = RR_NATIVE, const Result* = nullptr);
+
+/*
+Repeats randomized roundings until one is feasible, for at most a given number of attempts (the cutoff, which comes after the bound).  The model is built once and each attempt only changes the bounds of the parent and child arcs.  Attempt k uses the k'th value of a NetgenRandom stream started from the seed, mapped to [1,99999999].  Returns 0 if a solution is found, filling the objective, time and arc flows of the successful attempt, its seed, and the number of tries; the solve time of every attempt is recorded either way.
+
+The last argument solves that many attempts at once, each thread on its own copy of the model (the CPLEX thread limit is split between them).  Threads take attempt numbers in increasing order and stop taking them once a lower-numbered attempt has succeeded, so the successful attempt, its seed and the number of tries are the same as when solving one at a time; attempts already running above it are finished and ignored.
+*/
+int solve_rr_attempts(const Instance&, const vector<double>&, const vector<double>&, long, int, double, int, Result&, int = 0, int = RR_NATIVE, const Result* = nullptr, int = 1);
+
+/*
+Runs several rounding rules (see RrVariant) against one instance, exactly as solve_rr_attempts() would run each of them with the same seed, cutoff and options, but building the model(s) only once: between rules only the rounding thresholds change.  Fills one result per rule with its objective, time, tries and arc flows (the objective and time are -999 for rules that reached the cutoff), and returns the number of rules for which a solution was found.  The CPLEX engine's models may be built from an incidence matrix passed in as the last argument (otherwise it's built here).
+*/
+int solve_rr_variants(const Instance&, const vector<double>&, const vector<double>&, long, const vector<RrVariant>&, int, vector<Result>&, int = 0, int = RR_NATIVE, const Result* = nullptr, int = 1, const NetworkMatrix* = nullptr);
@@ -0,0 +1,806 @@
+/*
+Side-constrained simplex for the LP relaxation (see SideSimplex.h).
+
+A basis solve B z = a goes through the partition.  The tree part of the network rows is solved first, leaves up; what that leaves in the binding side rows is solved with the working basis; the tree is solved again with the working arcs' share taken out; and the basic slacks take up what's left in their own side rows.  Solving y B = g goes the other way: the basic slacks fix the duals of their rows, the tree gives node potentials for those, the working arcs' reduced costs give the duals of the binding rows through the working basis, and the potentials are worked out again with every dual.  The product-form updates are applied after the first and before the second.
+*/
+
+#include <cmath>
+#include <chrono>
+#include <algorithm>
+#include "SideSimplex.h"
+#include "LpBasis.h"
+#include "Timer.h"
+using namespace std;
+
+#define ETA_LIMIT 64 // pivots between refactorizations
+#define PRIMAL_TOL 1e-9 // how far a value may stray outside its bounds
+#define DUAL_TOL 1e-9 // how negative a reduced cost must be to enter
+#define PIVOT_TOL 1e-9 // smallest usable pivot
+
+// Sets up the ground node, dump arcs, slacks and artificial arcs for an instance.
+SideSimplex::SideSimplex(const Instance & instance) : inst(instance)
+{
+	node_count = inst.NODES + 1;
+	long ground = inst.NODES;
+	long root = node_count;
+	side_count = inst.INTER;
+
+	// Instance arcs, with auxiliary arcs ending at the ground node
+	for (long i = 0; i < inst.DENSITY; i++)
+	{
+		source.push_back(inst.tail[i]);
+		target.push_back(inst.head[i] >= 0 ? inst.head[i] : ground);
+		cost.push_back(inst.c[i]);
+		upper.push_back(inst.u[i]);
+	}
+
+	// Supplies, with the ground node taking up the imbalance
+	supply.assign(node_count, 0);
+	double total = 0;
+	for (long i = 0; i < inst.NODES; i++)
+	{
+		supply[i] = inst.b[i];
+		total += inst.b[i];
+	}
+	supply[ground] = -total;
+
+	// Dump arcs for relaxed sources
+	for (long i = 0; i < inst.NODES; i++)
+	{
+		if (inst.PARENT == 0 && i < inst.SOURCES && inst.b[i] > 0)
+		{
+			source.push_back(i);
+			target.push_back(ground);
+			cost.push_back(0);
+			upper.push_back(inst.b[i]);
+		}
+	}
+	arc_count = source.size();
+
+	// Slacks, then artificial arcs (pointed whichever way the node's supply goes when a solve starts)
+	for (long i = 0; i < side_count; i++)
+	{
+		source.push_back(-1);
+		target.push_back(-1);
+		cost.push_back(0);
+		upper.push_back(INFINITY);
+	}
+	for (long v = 0; v < node_count; v++)
+	{
+		source.push_back(v);
+		target.push_back(root);
+		cost.push_back(0);
+		upper.push_back(INFINITY);
+	}
+	col_count = source.size();
+	row_count = node_count + side_count;
+
+	// Side constraint entries: u[child] at the parent, -u[parent] at the child (each divided by the larger of the two, to keep them no bigger than the network's), and -1 at the slack
+	side_start.assign(col_count + 1, 0);
+	for (long i = 0; i < side_count; i++)
+	{
+		side_start[inst.parent[i] + 1]++;
+		side_start[inst.child[i] + 1]++;
+		side_start[arc_count + i + 1]++;
+	}
+	for (long j = 0; j < col_count; j++)
+		side_start[j + 1] += side_start[j];
+	side_row.resize(side_start[col_count]);
+	side_coef.resize(side_start[col_count]);
+	vector<long> next(side_start.begin(), side_start.end() - 1);
+	for (long i = 0; i < side_count; i++)
+	{
+		double u_parent = inst.u[inst.parent[i]];
+		double u_child = inst.u[inst.child[i]];
+		double scale = max(u_parent, u_child);
+		long k = next[inst.parent[i]]++;
+		side_row[k] = i;
+		side_coef[k] = (scale > 0 ? u_child / scale : 0);
+		k = next[inst.child[i]]++;
+		side_row[k] = i;
+		side_coef[k] = (scale > 0 ? -u_parent / scale : 0);
+		k = next[arc_count + i]++;
+		side_row[k] = i;
+		side_coef[k] = -1;
+	}
+
+	node_work.resize(node_count + 1);
+	side_work.resize(side_count);
+	pi.resize(node_count + 1);
+	sigma.resize(side_count);
+	working = 0;
+}
+
+// Starts from the basis of artificial arcs and slacks, and runs phase 1 and then phase 2.  Returns 0 if optimal, filling the objective, SOLVE_INFEASIBLE if phase 1 ends with flow left on the artificial arcs, or -1 if either phase fails (the basis became numerically singular, or the pivots ran past their limit), which proves nothing about the instance.
+int SideSimplex::solve(double & objective)
+{
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	stats = SideStats();
+	long root = node_count;
+	long first_artificial = arc_count + side_count;
+
+	// Every arc at 0, every slack basic at 0, and every node hung from the root by an artificial arc carrying its supply
+	value.assign(col_count, 0);
+	at_upper.assign(col_count, 0);
+	position.assign(col_count, -1);
+	basic.resize(row_count);
+	double total = 0;
+	for (long v = 0; v < node_count; v++)
+	{
+		long e = first_artificial + v;
+		source[e] = (supply[v] >= 0 ? v : root);
+		target[e] = (supply[v] >= 0 ? root : v);
+		upper[e] = INFINITY;
+		basic[v] = e;
+		position[e] = v;
+		total += fabs(supply[v]);
+	}
+	for (long i = 0; i < side_count; i++)
+	{
+		basic[node_count + i] = arc_count + i;
+		position[arc_count + i] = node_count + i;
+	}
+
+	// Phase 1: drive the flow off the artificial arcs
+	phase_cost.assign(col_count, 0);
+	for (long v = 0; v < node_count; v++)
+		phase_cost[first_artificial + v] = 1;
+	int output = refactor();
+	if (output == 0)
+		output = run();
+	if (output != 0)
+	{
+		stats.time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+		return -1;
+	}
+	double infeasibility = 0;
+	for (long v = 0; v < node_count; v++)
+		infeasibility += value[first_artificial + v];
+	if (infeasibility > 1e-6 * (1 + total))
+	{
+		stats.time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+		return SOLVE_INFEASIBLE;
+	}
+
+	// Phase 2: the real costs, with the artificial arcs held at 0
+	for (long v = 0; v < node_count; v++)
+		upper[first_artificial + v] = 0;
+	phase_cost = cost;
+	output = run();
+	if (output == 0)
+		output = refactor(); // recomputes the values from scratch
+	stats.time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	if (output != 0)
+		return -1;
+
+	objective = 0;
+	for (long a = 0; a < inst.DENSITY; a++)
+		objective += cost[a] * value[a];
+	return 0;
+}
+
+/*
+Pivots until no column prices out.  Returns 0 when optimal, or -1 if the basis becomes singular or the pivots run on far longer than they should.
+*/
+int SideSimplex::run()
+{
+	long candidates = arc_count + side_count; // artificial arcs never enter
+	long block_size = max(10L, (long)sqrt((double)candidates));
+	long limit = stats.pivots + stats.flips + 50 * (col_count + row_count);
+	long next_col = 0;
+	while (true)
+	{
+		if ((long)eta_position.size() >= ETA_LIMIT && refactor() != 0)
+			return -1;
+		btran();
+
+		// Block search pricing, as in the network simplex
+		long entering = -1;
+		double best = DUAL_TOL;
+		long count = block_size;
+		for (long k = 0; k < candidates; k++)
+		{
+			long j = next_col + k;
+			if (j >= candidates)
+				j -= candidates;
+			if (position[j] < 0)
+			{
+				double d = reduced_cost(j);
+				double violation = (at_upper[j] ? d : -d);
+				if (violation > best)
+				{
+					best = violation;
+					entering = j;
+				}
+			}
+			if (--count == 0)
+			{
+				if (entering >= 0)
+				{
+					next_col = j;
+					break;
+				}
+				count = block_size;
+			}
+		}
+		if (entering < 0)
+			return 0;
+
+		// The entering column moves by sign*t, and each basic column by -sign*t*alpha
+		ftran(entering);
+		double sign = (at_upper[entering] ? -1 : 1);
+
+		// Harris ratio test: the largest step allowed with the bounds relaxed by the tolerance, then the largest pivot among the columns that block within it
+		double bound = upper[entering];
+		for (long r = 0; r < row_count; r++)
+		{
+			double a = sign * alpha[r];
+			long b = basic[r];
+			if (a > PIVOT_TOL)
+				bound = min(bound, (value[b] + PRIMAL_TOL) / a);
+			else if (a < -PIVOT_TOL && upper[b] < INFINITY)
+				bound = min(bound, (upper[b] - value[b] + PRIMAL_TOL) / -a);
+		}
+		if (bound == INFINITY)
+			return -1; // can't happen, since every arc is bounded
+		long leaving = -1;
+		double step = upper[entering];
+		double largest = 0;
+		for (long r = 0; r < row_count; r++)
+		{
+			double a = sign * alpha[r];
+			long b = basic[r];
+			double ratio;
+			if (a > PIVOT_TOL)
+				ratio = value[b] / a;
+			else if (a < -PIVOT_TOL && upper[b] < INFINITY)
+				ratio = (upper[b] - value[b]) / -a;
+			else
+				continue;
+			if (ratio <= bound && fabs(a) > largest)
+			{
+				largest = fabs(a);
+				leaving = r;
+				step = ratio;
+			}
+		}
+		if (upper[entering] <= bound && (leaving < 0 || upper[entering] <= step))
+		{
+			leaving = -1;
+			step = upper[entering];
+		}
+		step = max(step, 0.0);
+
+		// Move along the edge
+		for (long r = 0; r < row_count; r++)
+			if (alpha[r] != 0)
+				value[basic[r]] -= sign * step * alpha[r];
+		if (leaving < 0)
+		{
+			at_upper[entering] = !at_upper[entering];
+			value[entering] = (at_upper[entering] ? upper[entering] : 0);
+			stats.flips++;
+		}
+		else
+		{
+			long out = basic[leaving];
+			at_upper[out] = (sign * alpha[leaving] < 0);
+			value[out] = (at_upper[out] ? upper[out] : 0);
+			value[entering] += sign * step;
+			position[out] = -1;
+			basic[leaving] = entering;
+			position[entering] = leaving;
+			at_upper[entering] = 0;
+			add_eta(leaving);
+			stats.pivots++;
+		}
+		if (stats.pivots + stats.flips > limit)
+			return -1;
+	}
+}
+
+// Reduced cost of a column under the current duals.
+double SideSimplex::reduced_cost(long j) const
+{
+	double d = phase_cost[j];
+	if (source[j] >= 0)
+		d -= pi[source[j]] - pi[target[j]];
+	for (long k = side_start[j]; k < side_start[j + 1]; k++)
+		d -= sigma[side_row[k]] * side_coef[k];
+	return d;
+}
+
+/*
+Chooses a spanning tree among the basic network columns (any basis has one), takes the other basic arcs as the working arcs and the binding side rows as the working rows, and factors the working basis.  Clears the product-form updates and recomputes the basic values.  Returns 0 if successful, or -1 if the basis is singular.
+*/
+int SideSimplex::refactor()
+{
+	stats.refactors++;
+	long root = node_count;
+
+	// Tree columns by union-find, then the rest
+	vector<long> component(node_count + 1);
+	for (long v = 0; v <= node_count; v++)
+		component[v] = v;
+	auto find = [&component](long v)
+	{
+		while (component[v] != v)
+		{
+			component[v] = component[component[v]];
+			v = component[v];
+		}
+		return v;
+	};
+	vector<long> tree_cols, working_cols, slack_cols;
+	for (long r = 0; r < row_count; r++)
+	{
+		long col = basic[r];
+		if (source[col] < 0)
+		{
+			slack_cols.push_back(col);
+			continue;
+		}
+		long a = find(source[col]);
+		long b = find(target[col]);
+		if (a != b)
+		{
+			component[a] = b;
+			tree_cols.push_back(col);
+		}
+		else
+			working_cols.push_back(col);
+	}
+	if ((long)tree_cols.size() != node_count)
+		return -1;
+
+	// Hang the tree from the root
+	vector<long> adj_start(node_count + 2, 0), adj(2 * node_count);
+	for (long col : tree_cols)
+	{
+		adj_start[source[col] + 1]++;
+		adj_start[target[col] + 1]++;
+	}
+	for (long v = 0; v <= node_count; v++)
+		adj_start[v + 1] += adj_start[v];
+	vector<long> next(adj_start.begin(), adj_start.end() - 1);
+	for (long col : tree_cols)
+	{
+		adj[next[source[col]]++] = col;
+		adj[next[target[col]]++] = col;
+	}
+	factor_basic.assign(row_count, -1);
+	parent.assign(node_count + 1, -1);
+	depth.assign(node_count + 1, 0);
+	dir.assign(node_count + 1, 0);
+	order.assign(1, root);
+	vector<char> seen(node_count + 1, 0);
+	seen[root] = 1;
+	for (size_t k = 0; k < order.size(); k++)
+	{
+		long u = order[k];
+		for (long j = adj_start[u]; j < adj_start[u + 1]; j++)
+		{
+			long col = adj[j];
+			long v = (source[col] == u ? target[col] : source[col]);
+			if (seen[v] == 1)
+				continue;
+			seen[v] = 1;
+			parent[v] = u;
+			depth[v] = depth[u] + 1;
+			dir[v] = (source[col] == v ? 1 : -1);
+			factor_basic[v] = col;
+			order.push_back(v);
+		}
+	}
+
+	// Working rows are the side rows whose slacks aren't basic
+	working = working_cols.size();
+	binding_index.assign(side_count, 0);
+	for (long col : slack_cols)
+		binding_index[col - arc_count] = -1;
+	binding.clear();
+	for (long i = 0; i < side_count; i++)
+	{
+		if (binding_index[i] >= 0)
+		{
+			binding_index[i] = binding.size();
+			binding.push_back(i);
+		}
+	}
+	if ((long)binding.size() != working)
+		return -1;
+	for (long k = 0; k < working; k++)
+		factor_basic[node_count + k] = working_cols[k];
+	for (size_t k = 0; k < slack_cols.size(); k++)
+		factor_basic[node_count + working + k] = slack_cols[k];
+	basic = factor_basic;
+	for (long r = 0; r < row_count; r++)
+		position[basic[r]] = r;
+	stats.max_working = max(stats.max_working, working);
+
+	// Working basis: each working arc's side entries, less those of the tree path it closes a cycle with
+	lu.assign(working * working, 0);
+	auto subtract = [&](long col, double amount, long k)
+	{
+		for (long j = side_start[col]; j < side_start[col + 1]; j++)
+			if (binding_index[side_row[j]] >= 0)
+				lu[binding_index[side_row[j]] * working + k] -= amount * side_coef[j];
+	};
+	for (long k = 0; k < working; k++)
+	{
+		long col = working_cols[k];
+		subtract(col, -1, k);
+		long u = source[col];
+		long v = target[col];
+		while (u != v)
+		{
+			// a unit of flow goes up the tree from the source and down to the target
+			if (depth[u] >= depth[v])
+			{
+				subtract(factor_basic[u], dir[u], k);
+				u = parent[u];
+			}
+			else
+			{
+				subtract(factor_basic[v], -dir[v], k);
+				v = parent[v];
+			}
+		}
+	}
+
+	// LU factors with partial pivoting
+	perm.resize(working);
+	for (long k = 0; k < working; k++)
+		perm[k] = k;
+	for (long c = 0; c < working; c++)
+	{
+		long pivot = c;
+		for (long r = c + 1; r < working; r++)
+			if (fabs(lu[r * working + c]) > fabs(lu[pivot * working + c]))
+				pivot = r;
+		if (fabs(lu[pivot * working + c]) < 1e-12)
+			return -1;
+		if (pivot != c)
+		{
+			for (long k = 0; k < working; k++)
+				swap(lu[c * working + k], lu[pivot * working + k]);
+			swap(perm[c], perm[pivot]);
+		}
+		for (long r = c + 1; r < working; r++)
+		{
+			double factor = lu[r * working + c] / lu[c * working + c];
+			lu[r * working + c] = factor;
+			if (factor != 0)
+				for (long k = c + 1; k < working; k++)
+					lu[r * working + k] -= factor * lu[c * working + k];
+		}
+	}
+
+	eta_position.clear();
+	eta_start.assign(1, 0);
+	eta_index.clear();
+	eta_pivot.clear();
+	eta_value.clear();
+	compute_values();
+	return 0;
+}
+
+// Sets every nonbasic column to its bound and solves for the basic values.
+void SideSimplex::compute_values()
+{
+	column_node.assign(node_count + 1, 0);
+	column_side.assign(side_count, 0);
+	for (long v = 0; v < node_count; v++)
+		column_node[v] = supply[v];
+	for (long j = 0; j < col_count; j++)
+	{
+		if (position[j] >= 0)
+			continue;
+		value[j] = (at_upper[j] ? upper[j] : 0);
+		if (value[j] == 0)
+			continue;
+		if (source[j] >= 0)
+		{
+			column_node[source[j]] -= value[j];
+			column_node[target[j]] += value[j];
+		}
+		for (long k = side_start[j]; k < side_start[j + 1]; k++)
+			column_side[side_row[k]] -= side_coef[k] * value[j];
+	}
+	alpha.resize(row_count);
+	solve_column(column_node, column_side, alpha);
+	for (long r = 0; r < row_count; r++)
+		value[basic[r]] = alpha[r];
+}
+
+// Each node passes what's left of its subtree's entries through its tree column, filling the tree positions of z.  The node entries are used up.
+void SideSimplex::tree_flow(vector<double> & node_part, vector<double> & z)
+{
+	for (long k = node_count; k > 0; k--)
+	{
+		long v = order[k];
+		z[v] = dir[v] * node_part[v];
+		node_part[parent[v]] += node_part[v];
+	}
+}
+
+// Node potentials for given costs of the tree columns (by node), with the root at 0.
+void SideSimplex::tree_potentials(const vector<double> & costs)
+{
+	pi[node_count] = 0;
+	for (long k = 1; k <= node_count; k++)
+	{
+		long v = order[k];
+		pi[v] = pi[parent[v]] + dir[v] * costs[v];
+	}
+}
+
+// Solves B z = a with the factored basis (see the top of the file), where a is given by its node part (with an entry for the root) and side part, both of which are used up.
+void SideSimplex::solve_column(vector<double> & node_part, vector<double> & side_part, vector<double> & z)
+{
+	// Tree alone, and what it leaves in the side rows
+	node_work = node_part;
+	tree_flow(node_work, z);
+	side_work = side_part;
+	for (long v = 0; v < node_count; v++)
+	{
+		if (z[v] == 0)
+			continue;
+		long col = factor_basic[v];
+		for (long k = side_start[col]; k < side_start[col + 1]; k++)
+			side_work[side_row[k]] -= side_coef[k] * z[v];
+	}
+
+	// Working basis, on the binding rows
+	working_work.resize(working);
+	for (long r = 0; r < working; r++)
+	{
+		double w = side_work[binding[perm[r]]];
+		for (long k = 0; k < r; k++)
+			w -= lu[r * working + k] * working_work[k];
+		working_work[r] = w;
+	}
+	for (long r = working - 1; r >= 0; r--)
+	{
+		double w = working_work[r];
+		for (long k = r + 1; k < working; k++)
+			w -= lu[r * working + k] * working_work[k];
+		working_work[r] = w / lu[r * working + r];
+	}
+
+	// Tree again, with the working arcs' flow taken out
+	for (long k = 0; k < working; k++)
+	{
+		long col = factor_basic[node_count + k];
+		z[node_count + k] = working_work[k];
+		node_part[source[col]] -= working_work[k];
+		node_part[target[col]] += working_work[k];
+	}
+	tree_flow(node_part, z);
+
+	// Each basic slack is its row's activity from the other basic columns, less the row's entry
+	for (long i = 0; i < side_count; i++)
+		side_part[i] = -side_part[i];
+	for (long r = 0; r < node_count + working; r++)
+	{
+		if (z[r] == 0)
+			continue;
+		long col = factor_basic[r];
+		for (long k = side_start[col]; k < side_start[col + 1]; k++)
+			side_part[side_row[k]] += side_coef[k] * z[r];
+	}
+	for (long r = node_count + working; r < row_count; r++)
+		z[r] = side_part[factor_basic[r] - arc_count];
+}
+
+// Solves y B = g with the factored basis (see the top of the file), for g given by basis position.  Fills the node potentials and side row duals.
+void SideSimplex::solve_row(vector<double> & g)
+{
+	// Basic slacks fix their rows' duals, and the binding rows start at 0
+	sigma.assign(side_count, 0);
+	for (long r = node_count + working; r < row_count; r++)
+		sigma[factor_basic[r] - arc_count] = -g[r];
+	tree_cost.resize(node_count + 1);
+	auto set_tree_costs = [&]()
+	{
+		for (long v = 0; v < node_count; v++)
+		{
+			long col = factor_basic[v];
+			double c = g[v];
+			for (long k = side_start[col]; k < side_start[col + 1]; k++)
+				c -= sigma[side_row[k]] * side_coef[k];
+			tree_cost[v] = c;
+		}
+	};
+	set_tree_costs();
+	tree_potentials(tree_cost);
+
+	// The working arcs' reduced costs give the binding rows' duals: solve (working basis)^T y = d
+	working_work.resize(working);
+	for (long k = 0; k < working; k++)
+	{
+		long col = factor_basic[node_count + k];
+		double d = g[node_count + k] - (pi[source[col]] - pi[target[col]]);
+		for (long j = side_start[col]; j < side_start[col + 1]; j++)
+			d -= sigma[side_row[j]] * side_coef[j];
+		working_work[k] = d;
+	}
+	for (long r = 0; r < working; r++)
+	{
+		double t = working_work[r];
+		for (long k = 0; k < r; k++)
+			t -= lu[k * working + r] * working_work[k];
+		working_work[r] = t / lu[r * working + r];
+	}
+	for (long r = working - 1; r >= 0; r--)
+	{
+		double t = working_work[r];
+		for (long k = r + 1; k < working; k++)
+			t -= lu[k * working + r] * working_work[k];
+		working_work[r] = t;
+	}
+	for (long r = 0; r < working; r++)
+		sigma[binding[perm[r]]] = working_work[r];
+
+	// Potentials with every dual
+	set_tree_costs();
+	tree_potentials(tree_cost);
+}
+
+// Solves for a column against the current basis, leaving it in alpha by basis position.
+void SideSimplex::ftran(long j)
+{
+	column_node.assign(node_count + 1, 0);
+	column_side.assign(side_count, 0);
+	if (source[j] >= 0)
+	{
+		column_node[source[j]] += 1;
+		column_node[target[j]] -= 1;
+	}
+	for (long k = side_start[j]; k < side_start[j + 1]; k++)
+		column_side[side_row[k]] += side_coef[k];
+	alpha.resize(row_count);
+	solve_column(column_node, column_side, alpha);
+
+	for (size_t e = 0; e < eta_position.size(); e++)
+	{
+		long r = eta_position[e];
+		double z = alpha[r] / eta_pivot[e];
+		for (long k = eta_start[e]; k < eta_start[e + 1]; k++)
+			alpha[eta_index[k]] -= eta_value[k] * z;
+		alpha[r] = z;
+	}
+}
+
+// Works out the duals of the current basis under the phase's costs.
+void SideSimplex::btran()
+{
+	row_cost.resize(row_count);
+	for (long r = 0; r < row_count; r++)
+		row_cost[r] = phase_cost[basic[r]];
+	for (long e = (long)eta_position.size() - 1; e >= 0; e--)
+	{
+		long r = eta_position[e];
+		double g = row_cost[r];
+		for (long k = eta_start[e]; k < eta_start[e + 1]; k++)
+			g -= eta_value[k] * row_cost[eta_index[k]];
+		row_cost[r] = g / eta_pivot[e];
+	}
+	solve_row(row_cost);
+}
+
+// Records the pivot just made at a basis position, with the entering column still in alpha.
+void SideSimplex::add_eta(long r)
+{
+	eta_position.push_back(r);
+	eta_pivot.push_back(alpha[r]);
+	for (long k = 0; k < row_count; k++)
+	{
+		if (k != r && fabs(alpha[k]) > 1e-14)
+		{
+			eta_index.push_back(k);
+			eta_value.push_back(alpha[k]);
+		}
+	}
+	eta_start.push_back(eta_index.size());
+}
+
+// Copies out the flow on every instance arc.
+void SideSimplex::get_flow(vector<double> & x) const
+{
+	x.resize(inst.DENSITY);
+	for (long a = 0; a < inst.DENSITY; a++)
+		x[a] = min(max(value[a], 0.0), upper[a]);
+}
+
+/*
+Copies out the basis in CPLEX's terms: each arc is basic or at a bound, and each node row is basic if its artificial arc is still basic or, for a relaxed source, if its dump arc is.  A relaxed source whose dump arc is empty sends its whole supply, so its row is at its upper bound.
+*/
+void SideSimplex::get_basis(vector<int> & arc_status, vector<int> & node_status) const
+{
+	arc_status.resize(inst.DENSITY);
+	for (long a = 0; a < inst.DENSITY; a++)
+		arc_status[a] = (position[a] >= 0 ? BASIS_BASIC : (at_upper[a] ? BASIS_UPPER : BASIS_LOWER));
+	node_status.assign(inst.NODES, BASIS_LOWER);
+	for (long v = 0; v < inst.NODES; v++)
+		if (position[arc_count + side_count + v] >= 0)
+			node_status[v] = BASIS_BASIC;
+	for (long a = inst.DENSITY; a < arc_count; a++)
+	{
+		long v = source[a];
+		if (position[a] >= 0)
+			node_status[v] = BASIS_BASIC;
+		else if (at_upper[a] == 0)
+			node_status[v] = BASIS_UPPER;
+	}
+}
+
+// Builds and solves the side-constrained simplex.  Outputs 0 if a solution is found, SOLVE_INFEASIBLE if there is none, or -1 if the simplex failed.
+int solve_lp_native(const Instance & inst, Result & res)
+{
+	PhaseTimer timer(PHASE_LP_BUILD);
+	SideSimplex * simplex = new SideSimplex(inst);
+	timer.next(PHASE_LP_SOLVE);
+	double objective;
+	int output = simplex->solve(objective);
+	timer.next(PHASE_LP_RESULTS);
+	if (output == 0)
+	{
+		res.objective = objective;
+		res.time = simplex->get_stats().time;
+		simplex->get_flow(res.flow);
+		res.parent_flow.resize(inst.INTER);
+		res.child_flow.resize(inst.INTER);
+		for (long i = 0; i < inst.INTER; i++)
+		{
+			// record parent/child flow values as fractions of capacity (a parent with no capacity counts as full, as in the side rows, and a child with none as empty)
+			long parent = inst.parent[i];
+			long child = inst.child[i];
+			res.parent_flow[i] = (inst.u[parent] > 0 ? res.flow[parent] / inst.u[parent] : 1);
+			res.child_flow[i] = (inst.u[child] > 0 ? res.flow[child] / inst.u[child] : 0);
+		}
+		res.load = 0;
+		for (long a = 0; a < inst.DENSITY; a++)
+			if (inst.u[a] > 0)
+				res.load += res.flow[a] / inst.u[a];
+		res.load /= inst.DENSITY;
+		simplex->get_basis(res.arc_status, res.node_status);
+	}
+	else
+	{
+		res.objective = -999;
+		res.time = -999;
+	}
+	delete simplex;
+	return output;
+}
+
+// Checks the bounds, then the balances (relaxed at the sources when parents are sink nodes, as in build_network()), then the side constraints.
+double lp_violation(const Instance & inst, const Result & res)
+{
+	if ((long)res.flow.size() != inst.DENSITY)
+		return INFINITY;
+	double worst = 0;
+	vector<double> net(inst.NODES, 0); // flow out minus flow in at each node
+	for (long a = 0; a < inst.DENSITY; a++)
+	{
+		double x = res.flow[a];
+		worst = max(worst, max(-x, x - inst.u[a]) / (1.0 + inst.u[a]));
+		net[inst.tail[a]] += x;
+		if (inst.head[a] >= 0)
+			net[inst.head[a]] -= x;
+	}
+	for (long v = 0; v < inst.NODES; v++)
+	{
+		double low = (inst.PARENT == 0 && v < inst.SOURCES ? 0 : inst.b[v]);
+		worst = max(worst, max(low - net[v], net[v] - inst.b[v]) / (1.0 + fabs(inst.b[v])));
+	}
+	for (long i = 0; i < inst.INTER; i++)
+	{
+		double u_parent = inst.u[inst.parent[i]];
+		double u_child = inst.u[inst.child[i]];
+		if (u_parent > 0 && u_child > 0) // otherwise the row holds for any flow within the bounds
+			worst = max(worst, res.flow[inst.child[i]] / u_child - res.flow[inst.parent[i]] / u_parent);
+	}
+	return worst;
+}
@@ -0,0 +1,88 @@
+#pragma once
+#include <vector>
+#include "Instance.h"
+using namespace std;
+
+// Work done by a side-constrained simplex solve
+struct SideStats
+{
+	long pivots = 0; // basis changes
+	long flips = 0; // entering columns that went straight to their other bound
+	long refactors = 0; // rebuilds of the tree and working basis
+	long max_working = 0; // largest working basis (binding side constraints)
+	double time = 0; // seconds
+};
+
+/*
+Native primal simplex for the LP relaxation, which is a network flow plus one side constraint per interdependency, x[parent]/u[parent] >= x[child]/u[child].  It's multiplied through by the two capacities, so that an arc with no capacity needs no special case, and divided by the larger of them to keep it on the network's scale: (u[child]*x[parent] - u[parent]*x[child])/max(u[parent], u[child]) - s[i] = 0 with a slack s[i] >= 0.  A parent with no capacity is then always full enough, just as in MILP_COMPACT (see MilpSolver.h).  The network is set up as for the network simplex (see MinCostFlow.h): a ground node takes the auxiliary arcs and the total demand, and relaxed sources get dump arcs.
+
+The basis is kept by primal partitioning.  Its network columns always contain a spanning tree (rooted at an extra node, to which every node has an artificial arc), and solves with the tree take one pass over it.  The other basic columns are the slacks of the side constraints that aren't binding, and as many arcs as there are binding side constraints; eliminating the tree from those arcs leaves a small dense "working basis" with one row per binding side constraint, which is kept as an LU factorization.  Between refactorizations, basis changes are kept as product-form updates on top of the tree and working basis, and every ETA_LIMIT pivots the tree is chosen again from the basic columns and the working basis is rebuilt.  With few binding side constraints, each pivot costs little more than a network simplex pivot.
+
+Phase 1 minimizes the flow on the artificial arcs, and phase 2 the arc costs with the artificial arcs held at 0.  Pricing is by block search, as in the network simplex, and the ratio test is Harris's two-pass test.
+*/
+class SideSimplex
+{
+private:
+	const Instance & inst;
+	long node_count; // real nodes plus the ground node; the root is numbered node_count
+	long arc_count; // instance arcs plus dump arcs
+	long side_count; // side constraints, one per interdependency
+	long col_count; // arcs, then a slack per side constraint, then an artificial arc per node
+	long row_count; // node rows (without the root's) plus side rows, which is the size of a basis
+	// columns
+	vector<long> source, target; // network ends, or -1 for slacks
+	vector<double> cost, phase_cost, upper, value;
+	vector<long> side_start, side_row; // side constraint entries of each column
+	vector<double> side_coef;
+	vector<double> supply;
+	// basis
+	vector<long> basic; // column at each basis position
+	vector<long> factor_basic; // column at each basis position as of the last refactorization, which the tree and working basis are made of
+	vector<long> position; // basis position of each column, or -1 if nonbasic
+	vector<char> at_upper; // whether each nonbasic column is at its upper bound
+	// spanning tree: node v's tree column is at basis position v (order lists the root first, then every node after its parent)
+	vector<long> parent, depth, order;
+	vector<signed char> dir; // 1 if the tree column points from the node to its parent, -1 otherwise
+	// working basis: the arcs at positions node_count to node_count+working-1, against the binding side rows
+	long working;
+	vector<long> binding; // side row of each working basis row
+	vector<long> binding_index; // working basis row of each side row, or -1 if its slack is basic
+	vector<double> lu; // working basis LU factors, row-major
+	vector<long> perm; // row order of the LU factors
+	// product-form updates since the last refactorization: for each, its position and the nonzeros of the entering column
+	vector<long> eta_position, eta_start, eta_index;
+	vector<double> eta_pivot, eta_value;
+	// duals
+	vector<double> pi, sigma; // node potentials (the root's is 0) and side row duals
+	// scratch space
+	vector<double> node_work, side_work, column_node, column_side, alpha, row_cost, tree_cost, working_work;
+	SideStats stats;
+	// methods
+	int refactor();
+	void compute_values();
+	void tree_flow(vector<double>&, vector<double>&);
+	void tree_potentials(const vector<double>&);
+	void solve_column(vector<double>&, vector<double>&, vector<double>&);
+	void solve_row(vector<double>&);
+	void ftran(long);
+	void btran();
+	double reduced_cost(long) const;
+	void add_eta(long);
+	int run();
+public:
+	SideSimplex(const Instance&);
+	int solve(double&); // output 0 and the objective if optimal, SOLVE_INFEASIBLE (see Instance.h) if infeasible, or -1 on a numerical failure or the pivot limit
+	void get_flow(vector<double>&) const; // flow on each instance arc from the last solve
+	void get_basis(vector<int>&, vector<int>&) const; // status of each arc and node row (see LpBasis.h) from the last solve
+	const SideStats& get_stats() const { return stats; } // work done by the last solve
+};
+
+/*
+Solves the LP relaxation with the side-constrained simplex instead of CPLEX.  Returns 0 if a solution is found, filling the same fields as solve_lp() (see LpSolver.h): the objective, time, load, parent/child flow fractions, and arc flows and basis.  An arc with no capacity counts as full if it's a parent and as empty if it's a child, and is left out of the load.  Like solve_lp(), returns SOLVE_INFEASIBLE only if the relaxation is infeasible, and -1 if the simplex fails without an answer.
+*/
+int solve_lp_native(const Instance&, Result&);
+
+/*
+Largest violation of the LP relaxation's constraints by a result's arc flows, so that a solution can be checked without CPLEX: the capacity bounds and node balances (each relative to 1 plus its right-hand side), and the side constraints x[parent]/u[parent] >= x[child]/u[child] (which any flow within the bounds satisfies when either arc has no capacity).  Returns infinity if the result doesn't have a flow for every arc.
+*/
+double lp_violation(const Instance&, const Result&);
@@ -0,0 +1,80 @@
+/*
+Phase timing (see Timer.h).  Every thread adds to its own totals, so timers never wait on each other; threads that work for another thread (such as parallel RR attempts) hand their totals back to it when they finish.
+*/
+
+#include <cstdlib>
+#include "Timer.h"
+using namespace std;
+
+const char * const phase_names[PHASE_COUNT] = { "generate", "parse", "write", "screen", "milp build", "milp extract", "milp solve", "milp results",
+	"lp build", "lp extract", "lp solve", "lp results", "rr build", "rr round", "rr oracle", "rr solve" };
+
+bool timing_enabled = (getenv("MCNFLI_TIMING") != nullptr); // the standalone programs time themselves if this environment variable is set
+
+// Adds another set of totals to these.
+void PhaseTimes::add(const PhaseTimes & other)
+{
+	for (int p = 0; p < PHASE_COUNT; p++)
+	{
+		seconds[p] += other.seconds[p];
+		count[p] += other.count[p];
+	}
+}
+
+void PhaseTimes::clear()
+{
+	for (int p = 0; p < PHASE_COUNT; p++)
+	{
+		seconds[p] = 0;
+		count[p] = 0;
+	}
+}
+
+// Prints each visited phase's name, total time, and number of visits.
+void PhaseTimes::print(ostream & out) const
+{
+	for (int p = 0; p < PHASE_COUNT; p++)
+		if (count[p] > 0)
+			out << phase_names[p] << '\t' << seconds[p] << '\t' << count[p] << '\n';
+}
+
+PhaseTimes & thread_phase_times()
+{
+	thread_local PhaseTimes totals;
+	return totals;
+}
+
+PhaseTimer::PhaseTimer(int first_phase)
+{
+	phase = -1;
+	if (timing_enabled)
+	{
+		phase = first_phase;
+		start = chrono::steady_clock::now();
+	}
+}
+
+void PhaseTimer::next(int next_phase)
+{
+	if (phase < 0 && timing_enabled == false)
+		return;
+	chrono::steady_clock::time_point now = chrono::steady_clock::now();
+	if (phase >= 0)
+	{
+		PhaseTimes & totals = thread_phase_times();
+		totals.seconds[phase] += chrono::duration<double>(now - start).count();
+		totals.count[phase]++;
+	}
+	phase = next_phase;
+	start = now;
+}
+
+void PhaseTimer::stop()
+{
+	if (phase < 0)
+		return;
+	PhaseTimes & totals = thread_phase_times();
+	totals.seconds[phase] += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	totals.count[phase]++;
+	phase = -1;
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <chrono>
+#include <ostream>
+using namespace std;
+
+// phases of a trial, in the order that they are reported
+#define PHASE_GENERATE 0 // NETGEN
+#define PHASE_PARSE 1 // reading instance, flow, and basis files
+#define PHASE_WRITE 2 // writing instance and result files
+#define PHASE_SCREEN 3 // feasibility checks of whole instances
+#define PHASE_MILP_BUILD 4 // building the Concert model
+#define PHASE_MILP_EXTRACT 5 // cplex.extract()
+#define PHASE_MILP_SOLVE 6 // cplex.solve()
+#define PHASE_MILP_RESULTS 7 // reading the solution back
+#define PHASE_LP_BUILD 8
+#define PHASE_LP_EXTRACT 9
+#define PHASE_LP_SOLVE 10
+#define PHASE_LP_RESULTS 11
+#define PHASE_RR_BUILD 12 // building the RR models (engine and oracle)
+#define PHASE_RR_ROUND 13 // rolling roundings and applying them as bounds
+#define PHASE_RR_ORACLE 14 // max-flow feasibility checks of roundings
+#define PHASE_RR_SOLVE 15 // flow engine solves
+#define PHASE_COUNT 16
+
+extern const char * const phase_names[PHASE_COUNT];
+extern bool timing_enabled; // set at startup (before any threads are started); when false, timers do nothing
+
+// Total time and number of visits for each phase
+struct PhaseTimes
+{
+	double seconds[PHASE_COUNT] = {};
+	long count[PHASE_COUNT] = {};
+	void add(const PhaseTimes&);
+	void clear();
+	void print(ostream&) const; // a line for each phase that was visited
+};
+
+PhaseTimes & thread_phase_times(); // the calling thread's totals
+
+/*
+Times one phase at a time on a monotonic clock, adding the time to the calling thread's totals when the phase ends: at the next phase, at stop(), or when the timer goes out of scope.  When timing is disabled, a timer only checks the flag.
+*/
+class PhaseTimer
+{
+private:
+	int phase; // current phase, or -1 if stopped
+	chrono::steady_clock::time_point start;
+	PhaseTimer(const PhaseTimer&) = delete;
+	PhaseTimer& operator=(const PhaseTimer&) = delete;
+public:
+	PhaseTimer(int);
+	~PhaseTimer() { stop(); }
+	void next(int); // end the current phase and start another
+	void stop();
+};